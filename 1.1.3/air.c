@@ -50,13 +50,15 @@ OF SUCH DAMAGE.
 
 #define DEBUG_AIR 0             ///< macro to debug air functions.
 
-double air_temperature = AIR_TEMPERATURE;       ///< air temperature in Celsius.
-double air_pressure = AIR_PRESSURE;     ///< air pressure.
-double air_humidity = AIR_HUMIDITY;     ///< air relative humidity.
-double air_velocity = WIND_VELOCITY;    ///< wind velocity.
-double air_uncertainty = WIND_UNCERTAINTY;      ///< wind velocity uncertainty.
-double air_angle = WIND_ANGLE;  ///< wind angle.
-double air_height = WIND_HEIGHT;
+__thread double air_temperature = AIR_TEMPERATURE;
+  ///< air temperature in Celsius.
+__thread double air_pressure = AIR_PRESSURE;    ///< air pressure.
+__thread double air_humidity = AIR_HUMIDITY;    ///< air relative humidity.
+__thread double air_velocity = WIND_VELOCITY;   ///< wind velocity.
+__thread double air_uncertainty = WIND_UNCERTAINTY;
+  ///< wind velocity uncertainty.
+__thread double air_angle = WIND_ANGLE; ///< wind angle.
+__thread double air_height = WIND_HEIGHT;
   ///< reference height to measure the wind velocity.
 
 /**
@@ -102,6 +104,34 @@ air_print (Air * a)
           a->dynamic_viscosity);
 }
 
+/**
+ * \fn void air_calculate (Air * a)
+ * \brief function to calculate the atmospheric variables from the temperature,
+ *   pressure, humidity and wind data of an Air struct.
+ * \param a
+ * \brief Air struct.
+ */
+void
+air_calculate (Air * a)
+{
+#if DEBUG_AIR
+  fprintf (stderr, "air_calculate: start\n");
+#endif
+  a->vx = a->velocity * cos (a->angle);
+  a->vy = a->velocity * sin (a->angle);
+  a->kelvin = a->temperature + KELVIN_TEMPERATURE;
+  a->dynamic_viscosity = air_viscosity (a);
+  a->saturation_pressure = air_saturation_pressure (a);
+  a->vapour_pressure = a->saturation_pressure * 0.01 * a->humidity;
+  a->density = (AIR_MOLECULAR_MASS * a->pressure
+                + (WATER_MOLECULAR_MASS -
+                   AIR_MOLECULAR_MASS) * a->vapour_pressure) / (R * a->kelvin);
+  a->kinematic_viscosity = a->dynamic_viscosity / a->density;
+#if DEBUG_AIR
+  fprintf (stderr, "air_calculate: end\n");
+#endif
+}
+
 /*
  * \fn void air_init (Air * a)
  * \brief function to init atmospheric variables.
@@ -121,16 +151,7 @@ air_init (Air * a)
   a->uncertainty = air_uncertainty;
   a->angle = M_PI / 180. * air_angle;
   a->height = air_height;
-  a->vx = a->velocity * cos (a->angle);
-  a->vy = a->velocity * sin (a->angle);
-  a->kelvin = a->temperature + KELVIN_TEMPERATURE;
-  a->dynamic_viscosity = air_viscosity (a);
-  a->saturation_pressure = air_saturation_pressure (a);
-  a->vapour_pressure = a->saturation_pressure * 0.01 * a->humidity;
-  a->density = (AIR_MOLECULAR_MASS * a->pressure
-                + (WATER_MOLECULAR_MASS -
-                   AIR_MOLECULAR_MASS) * a->vapour_pressure) / (R * a->kelvin);
-  a->kinematic_viscosity = a->dynamic_viscosity / a->density;
+  air_calculate (a);
   air_print (a);
 #if DEBUG_AIR
   fprintf (stderr, "air_init: end\n");
@@ -258,6 +279,31 @@ exit_on_error:
   return 0;
 }
 
+/**
+ * \fn void air_wind_sample (Air * a, double angle, double deviation)
+ * \brief function to set the wind with a sampled uncertainty.
+ * \param a
+ * \brief Air struct.
+ * \param angle
+ * \brief angle of the wind uncertainty.
+ * \param deviation
+ * \brief standard normal deviation of the wind uncertainty.
+ */
+void
+air_wind_sample (Air * a, double angle, double deviation)
+{
+  float uncertainty;
+#if DEBUG_AIR
+  fprintf (stderr, "air_wind_sample: start\n");
+#endif
+  uncertainty = a->uncertainty * fmin (5., fabs (deviation));
+  a->u = a->vx + uncertainty * cos (angle);
+  a->v = a->vy + uncertainty * sin (angle);
+#if DEBUG_AIR
+  fprintf (stderr, "air_wind_sample: end\n");
+#endif
+}
+
 /**
  * \fn void air_wind_uncertainty (Air * a, gsl_rng *rng)
  * \brief function to generate a random wind.
@@ -269,14 +315,12 @@ exit_on_error:
 void
 air_wind_uncertainty (Air * a, gsl_rng * rng)
 {
-  float uncertainty, angle;
+  float angle;
 #if DEBUG_AIR
   fprintf (stderr, "air_wind_uncertainty: start\n");
 #endif
   angle = 2 * M_PI * gsl_rng_uniform (rng);
-  uncertainty = a->uncertainty * fmin (5., fabs (gsl_ran_ugaussian (rng)));
-  a->u = a->vx + uncertainty * cos (angle);
-  a->v = a->vy + uncertainty * sin (angle);
+  air_wind_sample (a, angle, gsl_ran_ugaussian (rng));
 #if DEBUG_AIR
   fprintf (stderr, "air_wind_uncertainty: end\n");
 #endif
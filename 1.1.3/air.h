@@ -62,16 +62,18 @@ typedef struct
 } Air;
 
 extern int nAirs;
-extern double air_temperature, air_pressure, air_humidity, air_velocity,
-  air_uncertainty, air_angle, air_height;
+extern __thread double air_temperature, air_pressure, air_humidity,
+  air_velocity, air_uncertainty, air_angle, air_height;
 
 double air_viscosity (Air * a);
 double air_saturation_pressure (Air * a);
 void air_print (Air * a);
+void air_calculate (Air * a);
 void air_init (Air * a);
 void air_error (char *message);
 void air_open_console (Air * a);
 int air_open_xml (Air * a, xmlNode * node);
+void air_wind_sample (Air * a, double angle, double deviation);
 void air_wind_uncertainty (Air * a, gsl_rng * rng);
 
 #if HAVE_GTK
@@ -0,0 +1,430 @@
+/*
+Sprinkler: a software to calculate drop trajectories in sprinkler irrigation.
+
+AUTHORS: Javier Burguete.
+
+Copyright 2012-2015, AUTHORS.
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+	1. Redistributions of source code must retain the above copyright notice,
+		this list of conditions and the following disclaimer.
+
+	2. Redistributions in binary form must reproduce the above copyright notice,
+		this list of conditions and the following disclaimer in the
+		documentation and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY AUTHORS ``AS IS'' AND ANY EXPRESS OR IMPLIED
+WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+SHALL AUTHORS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+
+/**
+ * \file batch.c
+ * \brief Source file to calculate the trajectories of a tabular drops batch.
+ *   Every row of the drops file is a drop defined by the columns:
+ *   x, y, z, velocity, horizontal angle, vertical angle, diameter, drag model
+ *   (constant, sphere or ovoid) and, with the constant model, the drag
+ *   coefficient. The columns are separated by commas, spaces or tabs and lines
+ *   starting by # are comments. The file is mapped in memory and every row is
+ *   parsed in place by the thread calculating it.
+ * \author Javier Burguete Tolosa.
+ * \copyright Copyright 2012-2015 Javier Burguete Tolosa, all rights reserved.
+ */
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <libxml/parser.h>
+#include <glib.h>
+#include <libintl.h>
+#include <gsl/gsl_rng.h>
+#include "config.h"
+#include "utils.h"
+#include "trace.h"
+#include "air.h"
+#include "drop.h"
+#include "measurement.h"
+#include "trajectory.h"
+#include "batch.h"
+
+#define DEBUG_BATCH 0           ///< macro to debug batch functions.
+
+#define BATCH_BLOCK 65536
+///< number of drops calculated before writing the results.
+#define BATCH_LINE 1024
+///< maximum length of an unterminated last line.
+
+/**
+ * \fn static inline int batch_separator (char c)
+ * \brief function to check if a character separates columns.
+ * \param c
+ * \brief character.
+ * \return 1 on a separator, 0 otherwise.
+ */
+static inline int
+batch_separator (char c)
+{
+  return c == ',' || c == ' ' || c == '\t' || c == '\r';
+}
+
+/**
+ * \fn void batch_error (char *message)
+ * \brief function to show an error message opening a Batch struct.
+ * \param message
+ * \brief error message.
+ */
+void
+batch_error (char *message)
+{
+  error_message = g_strconcat (gettext ("Batch file"), ": ", message, NULL);
+}
+
+/**
+ * \fn int batch_parse (const char *p, const char *end, Drop * d, double *x)
+ * \brief function to parse a drops file row. The row has to be ended by a
+ *   character which can not be part of a number.
+ * \param p
+ * \brief row start.
+ * \param end
+ * \brief row end.
+ * \param d
+ * \brief Drop struct to set the drag resistance model.
+ * \param x
+ * \brief array of the drop initial data (see trajectory_landing()).
+ * \return 1 on success, 0 on error.
+ */
+int
+batch_parse (const char *p, const char *end, Drop * d, double *x)
+{
+  const char *q;
+  char *r;
+  unsigned int i, n;
+  for (i = n = 0; i < 8; ++i)
+    {
+      while (p < end && batch_separator (*p))
+        ++p;
+      if (p >= end)
+        break;
+      if (i == 7)
+        {
+          for (q = p; q < end && !batch_separator (*q); ++q);
+          if (q - p == xmlStrlen (XML_CONSTANT)
+              && !strncmp (p, (const char *) XML_CONSTANT, q - p))
+            d->drag_model = DROP_DRAG_MODEL_CONSTANT;
+          else if (q - p == xmlStrlen (XML_SPHERE)
+                   && !strncmp (p, (const char *) XML_SPHERE, q - p))
+            d->drag_model = DROP_DRAG_MODEL_SPHERE;
+          else if (q - p == xmlStrlen (XML_OVOID)
+                   && !strncmp (p, (const char *) XML_OVOID, q - p))
+            d->drag_model = DROP_DRAG_MODEL_OVOID;
+          else
+            return 0;
+          p = q;
+          ++n;
+          break;
+        }
+      x[i] = strtod (p, &r);
+      if (r == p || r > end)
+        return 0;
+      p = r;
+      ++n;
+    }
+  if (n < 8)
+    return 0;
+  d->drag_coefficient = 0.;
+  if (d->drag_model == DROP_DRAG_MODEL_CONSTANT)
+    {
+      while (p < end && batch_separator (*p))
+        ++p;
+      if (p >= end)
+        return 0;
+      d->drag_coefficient = strtod (p, &r);
+      if (r == p || r > end)
+        return 0;
+    }
+  return 1;
+}
+
+/**
+ * \fn int batch_drop (Batch * b, Air * a, Trajectory * t, gsl_rng * rng, \
+ *   unsigned long int row, const char *line, double *y)
+ * \brief function to calculate the trajectory of a drops file row with its own
+ *   pseudo-random numbers substream.
+ * \param b
+ * \brief Batch struct.
+ * \param a
+ * \brief Air struct.
+ * \param t
+ * \brief Trajectory struct.
+ * \param rng
+ * \brief GSL pseudo-random numbers generator struct.
+ * \param row
+ * \brief drop number.
+ * \param line
+ * \brief row start.
+ * \param y
+ * \brief array of the final drop state: time, position, velocity, axis ratio
+ *   and diameter.
+ * \return 1 on success, 0 on error.
+ */
+int
+batch_drop (Batch * b, Air * a, Trajectory * t, gsl_rng * rng,
+            unsigned long int row, const char *line, double *y)
+{
+  char buffer[BATCH_LINE];
+  const char *end;
+  double x[7];
+  end = memchr (line, '\n', b->end - line);
+  if (end)
+    {
+      if (!batch_parse (line, end, t->drop, x))
+        return 0;
+    }
+  else
+    {
+      // the last line is not ended by a new line
+      if (b->end - line >= BATCH_LINE)
+        return 0;
+      memcpy (buffer, line, b->end - line);
+      buffer[b->end - line] = '\0';
+      if (!batch_parse (buffer, buffer + (b->end - line), t->drop, x))
+        return 0;
+    }
+  gsl_rng_set (rng, random_seed (RANDOM_SEED, row));
+  trajectory_landing (t, a, rng, x, b->bed_level, b->dt, b->cfl, y);
+  return 1;
+}
+
+/**
+ * \fn static gpointer batch_thread (BatchThread * data)
+ * \brief function to calculate the batch drops of a thread.
+ * \param data
+ * \brief BatchThread struct.
+ * \return NULL.
+ */
+static gpointer
+batch_thread (BatchThread * data)
+{
+  gsl_rng *rng;
+  unsigned long long int t0;
+  unsigned int i;
+  if (trace_enabled)
+    t0 = trace_time ();
+  rng = gsl_rng_alloc (gsl_rng_taus);
+  data->error = 0;
+  for (i = data->first; i < data->last; ++i)
+    if (!batch_drop (data->batch, data->air, data->trajectory, rng,
+                     data->row + i, data->line[i], data->output + 9 * i))
+      {
+        data->error = 1;
+        data->error_row = data->row + i;
+        break;
+      }
+  gsl_rng_free (rng);
+  if (trace_enabled)
+    {
+      trace_event ("worker", t0, trace_time ());
+      trace_flush ();
+    }
+  return NULL;
+}
+
+/**
+ * \fn int batch_open_xml (Batch * b, Air * a, xmlNode * node)
+ * \brief function to open a Batch struct on a XML node.
+ * \param b
+ * \brief Batch struct.
+ * \param a
+ * \brief Air struct.
+ * \param node
+ * \brief XML node.
+ * \return 1 on success, 0 on error.
+ */
+int
+batch_open_xml (Batch * b, Air * a, xmlNode * node)
+{
+  xmlChar *buffer;
+  int k;
+#if DEBUG_BATCH
+  fprintf (stderr, "batch_open_xml: start\n");
+#endif
+  b->mapped = NULL;
+  if (xmlStrcmp (node->name, XML_BATCH))
+    {
+      batch_error (gettext ("bad label"));
+      goto exit_on_error;
+    }
+  b->bed_level = xml_node_get_float_with_default (node, XML_BED_LEVEL, 0., &k);
+  if (!k)
+    {
+      batch_error (gettext ("bad bed level"));
+      goto exit_on_error;
+    }
+  b->dt = xml_node_get_float_with_default (node, XML_DT, DT, &k);
+  if (!k)
+    {
+      batch_error (gettext ("bad time step size"));
+      goto exit_on_error;
+    }
+  b->cfl = xml_node_get_float_with_default (node, XML_CFL, CFL, &k);
+  if (!k)
+    {
+      batch_error (gettext ("bad CFL number"));
+      goto exit_on_error;
+    }
+  if (!node->children)
+    {
+      batch_error (gettext ("no air"));
+      goto exit_on_error;
+    }
+  if (!air_open_xml (a, node->children))
+    goto exit_on_error;
+  buffer = xmlGetProp (node, XML_FILE);
+  if (!buffer)
+    {
+      batch_error (gettext ("no drops file"));
+      goto exit_on_error;
+    }
+  b->mapped = g_mapped_file_new ((char *) buffer, FALSE, NULL);
+  xmlFree (buffer);
+  if (!b->mapped)
+    {
+      batch_error (gettext ("unable to open the drops file"));
+      goto exit_on_error;
+    }
+  b->contents = g_mapped_file_get_contents (b->mapped);
+  b->end = b->contents + g_mapped_file_get_length (b->mapped);
+#if DEBUG_BATCH
+  fprintf (stderr, "batch_open_xml: end\n");
+#endif
+  return 1;
+
+exit_on_error:
+#if DEBUG_BATCH
+  fprintf (stderr, "batch_open_xml: end\n");
+#endif
+  return 0;
+}
+
+/**
+ * \fn int batch_run_xml (Batch * b, Air * a, xmlNode * node, char *result)
+ * \brief function to calculate the trajectories of a drops batch on a XML
+ *   node. The drops are calculated by blocks in parallel threads and the final
+ *   drop states are written on the results file in the rows order.
+ * \param b
+ * \brief Batch struct.
+ * \param a
+ * \brief Air struct.
+ * \param node
+ * \brief XML node.
+ * \param result
+ * \brief results file name.
+ * \return 1 on success, 0 on error.
+ */
+int
+batch_run_xml (Batch * b, Air * a, xmlNode * node, char *result)
+{
+  char buffer[64];
+  BatchThread *data;
+  GThread **thread;
+  FILE *file;
+  const char **line, *p;
+  double *output, *y;
+  unsigned long int row;
+  unsigned int i, j, n, nlines;
+  int error_code;
+#if DEBUG_BATCH
+  fprintf (stderr, "batch_run_xml: start\n");
+#endif
+  error_code = 0;
+  if (!batch_open_xml (b, a, node))
+    goto exit_run;
+  file = fopen (result, "w");
+  if (!file)
+    {
+      batch_error (gettext ("unable to open the results file"));
+      goto exit_mapped;
+    }
+  n = MAX (1, nthreads);
+  line = (const char **) g_malloc (BATCH_BLOCK * sizeof (const char *));
+  output = (double *) g_malloc (9 * BATCH_BLOCK * sizeof (double));
+  data = (BatchThread *) g_malloc (n * sizeof (BatchThread));
+  thread = (GThread **) g_malloc (n * sizeof (GThread *));
+  for (row = 0, p = b->contents; p < b->end; row += nlines)
+    {
+      // indexing a block of rows
+      for (nlines = 0; p < b->end && nlines < BATCH_BLOCK;)
+        {
+          while (p < b->end && (batch_separator (*p) || *p == '\n'))
+            ++p;
+          if (p >= b->end)
+            break;
+          if (*p != '#')
+            line[nlines++] = p;
+          p = memchr (p, '\n', b->end - p);
+          if (!p)
+            p = b->end;
+        }
+
+      // calculating the block
+      for (i = 0; i < n; ++i)
+        {
+          data[i].batch = b;
+          memcpy (data[i].air, a, sizeof (Air));
+          data[i].line = line;
+          data[i].output = output;
+          data[i].row = row;
+          data[i].first = i * nlines / n;
+          data[i].last = (i + 1) * nlines / n;
+          thread[i]
+            = g_thread_new (NULL, (GThreadFunc) batch_thread, data + i);
+        }
+      for (i = 0; i < n; ++i)
+        g_thread_join (thread[i]);
+      for (i = 0; i < n; ++i)
+        if (data[i].error)
+          {
+            snprintf (buffer, 64, "%lu", data[i].error_row + 1);
+            error_message = g_strconcat (gettext ("Batch file"), ": ",
+                                         gettext ("bad drop"), " ", buffer,
+                                         NULL);
+            goto exit_block;
+          }
+
+      // writing the results
+      for (j = 0; j < nlines; ++j)
+        {
+          y = output + 9 * j;
+          fprintf (file, "%lg %lg %lg %lg %lg %lg %lg %lg %lg\n",
+                   y[0], y[1], y[2], y[3], y[4], y[5], y[6], y[7], y[8]);
+        }
+    }
+  error_code = 1;
+
+exit_block:
+  g_free (thread);
+  g_free (data);
+  g_free (output);
+  g_free (line);
+  fclose (file);
+
+exit_mapped:
+  g_mapped_file_unref (b->mapped);
+
+exit_run:
+#if DEBUG_BATCH
+  fprintf (stderr, "batch_run_xml: end\n");
+#endif
+  return error_code;
+}
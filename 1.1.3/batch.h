@@ -0,0 +1,79 @@
+/*
+Sprinkler: a software to calculate drop trajectories in sprinkler irrigation.
+
+AUTHORS: Javier Burguete.
+
+Copyright 2012-2015, AUTHORS.
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+	1. Redistributions of source code must retain the above copyright notice,
+		this list of conditions and the following disclaimer.
+
+	2. Redistributions in binary form must reproduce the above copyright notice,
+		this list of conditions and the following disclaimer in the
+		documentation and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY AUTHORS ``AS IS'' AND ANY EXPRESS OR IMPLIED
+WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+SHALL AUTHORS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+
+/**
+ * \file batch.h
+ * \brief Header file to calculate the trajectories of a tabular drops batch.
+ * \author Javier Burguete Tolosa.
+ * \copyright Copyright 2012-2015 Javier Burguete Tolosa, all rights reserved.
+ */
+#ifndef BATCH__H
+#define BATCH__H 1
+
+/**
+ * \struct Batch
+ * \brief struct to define a tabular drops batch mapped in memory.
+ */
+typedef struct
+{
+  GMappedFile *mapped;          ///< mapped drops file.
+  const char *contents;         ///< drops file contents.
+  const char *end;              ///< end of the drops file contents.
+  double bed_level;             ///< bed level.
+  double dt;                    ///< numerical time step size.
+  double cfl;                   ///< stability number.
+} Batch;
+
+/**
+ * \struct BatchThread
+ * \brief struct to define the data of a thread calculating batch drops.
+ */
+typedef struct
+{
+  Batch *batch;                 ///< Batch struct.
+  Air air[1];                   ///< Air struct copy.
+  Trajectory trajectory[1];     ///< Trajectory struct.
+  const char **line;            ///< array of line starts.
+  double *output;               ///< array of drop results.
+  unsigned long int row;        ///< number of the first row of the block.
+  unsigned long int error_row;  ///< number of the first bad row.
+  unsigned int first;           ///< first drop of the block.
+  unsigned int last;            ///< last drop of the block.
+  unsigned int error;           ///< 1 on a bad row, 0 otherwise.
+} BatchThread;
+
+void batch_error (char *message);
+int batch_parse (const char *p, const char *end, Drop * d, double *x);
+int batch_drop (Batch * b, Air * a, Trajectory * t, gsl_rng * rng,
+                unsigned long int row, const char *line, double *y);
+int batch_open_xml (Batch * b, Air * a, xmlNode * node);
+int batch_run_xml (Batch * b, Air * a, xmlNode * node, char *result);
+
+#endif
@@ -0,0 +1,736 @@
+/*
+Sprinkler: a software to calculate drop trajectories in sprinkler irrigation.
+
+AUTHORS: Javier Burguete.
+
+Copyright 2012-2015, AUTHORS.
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+	1. Redistributions of source code must retain the above copyright notice,
+		this list of conditions and the following disclaimer.
+
+	2. Redistributions in binary form must reproduce the above copyright notice,
+		this list of conditions and the following disclaimer in the
+		documentation and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY AUTHORS ``AS IS'' AND ANY EXPRESS OR IMPLIED
+WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+SHALL AUTHORS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+
+/**
+ * \file bench.c
+ * \brief File to measure the computational cost of the drop movement, drag
+ *   resistance and trajectory integration functions. The benchmarks are built
+ *   with the instrumentation counters to count the integration steps and the
+ *   drop_move evaluations of trajectory_calculate.
+ * \author Javier Burguete Tolosa.
+ * \copyright Copyright 2012-2015 Javier Burguete Tolosa, all rights reserved.
+ */
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <libxml/parser.h>
+#include <glib.h>
+#include <gsl/gsl_rng.h>
+#include "config.h"
+#include "utils.h"
+#include "instrument.h"
+#include "air.h"
+#include "drop.h"
+#include "measurement.h"
+#include "trajectory.h"
+#include "sprinkler.h"
+
+#define BENCH_REPETITIONS 21
+///< number of timed repetitions of every benchmark.
+#define BENCH_TIME 20000
+///< minimum time of a repetition in microseconds.
+#define BENCH_VELOCITIES 64
+///< number of drop velocities used to evaluate the drag functions.
+#define BENCH_RESET 256
+///< number of integration steps before restarting the drop.
+#define BENCH_DIAMETERS 6
+///< number of drop diameters.
+#define BENCH_DTS 7
+///< number of time step sizes of the accuracy benchmark.
+#define BENCH_CFLS 7
+///< number of CFL numbers of the accuracy benchmark.
+#define BENCH_REFERENCE_DT 0.000001
+///< time step size of the reference trajectories.
+#define BENCH_REFERENCE_CFL 0.001
+///< CFL number of the reference trajectories.
+#define BENCH_DROPS 16384
+///< minimum number of drops of the thread scaling benchmark.
+
+/**
+ * \struct Bench
+ * \brief struct to define the data of a benchmark.
+ */
+typedef struct
+{
+  Air air[1];                   ///< Air struct.
+  Trajectory trajectory[1];     ///< Trajectory struct.
+  Trajectory trajectory0[1];    ///< initial Trajectory struct.
+  double velocity[BENCH_VELOCITIES];    ///< array of drop velocities.
+  double sink;                  ///< sum of the results.
+} Bench;
+
+/**
+ * \struct BenchSetting
+ * \brief struct to define the results of a numerical setting in the accuracy
+ *   benchmark.
+ */
+typedef struct
+{
+  double dt;                    ///< time step size.
+  double cfl;                   ///< CFL number.
+  double error;                 ///< maximum landing point error.
+  double evaluations;           ///< number of drop_move evaluations.
+  unsigned int pareto;          ///< 1 if on the Pareto frontier, 0 otherwise.
+} BenchSetting;
+
+static const double bench_diameter[BENCH_DIAMETERS]
+  = { 0.0004, 0.001, 0.002, 0.004, 0.006, 0.008 };
+///< array of drop diameters.
+
+/**
+ * \fn static int bench_compare (const void *a, const void *b)
+ * \brief function to compare two doubles with qsort.
+ * \param a
+ * \brief pointer to the first double.
+ * \param b
+ * \brief pointer to the second double.
+ * \return -1 if a < b, 1 if a > b, 0 otherwise.
+ */
+static int
+bench_compare (const void *a, const void *b)
+{
+  double x, y;
+  x = *(const double *) a;
+  y = *(const double *) b;
+  return (x > y) - (x < y);
+}
+
+/**
+ * \fn static void bench_measure (const char *label, \
+ *   void (*f) (Bench *, unsigned long int), Bench * b, double steps)
+ * \brief function to time a benchmark. The number of calls of a repetition is
+ *   doubled until it lasts at least BENCH_TIME microseconds, then the median
+ *   and the median absolute deviation of BENCH_REPETITIONS repetitions are
+ *   reported.
+ * \param label
+ * \brief benchmark label.
+ * \param f
+ * \brief pointer to the function doing a number of calls.
+ * \param b
+ * \brief Bench struct.
+ * \param steps
+ * \brief number of integration steps of every call or 0 if not applicable.
+ */
+static void
+bench_measure (const char *label, void (*f) (Bench *, unsigned long int),
+               Bench * b, double steps)
+{
+  double time[BENCH_REPETITIONS], deviation[BENCH_REPETITIONS];
+  double median, mad;
+  gint64 t0;
+  unsigned long int n;
+  unsigned int i;
+  for (n = 1;; n *= 2)
+    {
+      t0 = g_get_monotonic_time ();
+      f (b, n);
+      if (g_get_monotonic_time () - t0 >= BENCH_TIME)
+        break;
+    }
+  for (i = 0; i < BENCH_REPETITIONS; ++i)
+    {
+      t0 = g_get_monotonic_time ();
+      f (b, n);
+      time[i] = 1e3 * (g_get_monotonic_time () - t0) / n;
+    }
+  qsort (time, BENCH_REPETITIONS, sizeof (double), bench_compare);
+  median = time[BENCH_REPETITIONS / 2];
+  for (i = 0; i < BENCH_REPETITIONS; ++i)
+    deviation[i] = fabs (time[i] - median);
+  qsort (deviation, BENCH_REPETITIONS, sizeof (double), bench_compare);
+  mad = deviation[BENCH_REPETITIONS / 2];
+  printf ("%-36s %12.2lf ns/call %6.2lf%%", label, median,
+          100. * mad / median);
+  if (steps > 0.)
+    printf (" %12.4le steps/s", 1e9 * steps / median);
+  printf ("\n");
+}
+
+/**
+ * \fn static void bench_init (Bench * b, double diameter, \
+ *   unsigned int drag_model)
+ * \brief function to init a drop emitted at 2 m height with a 20 m/s velocity
+ *   and a 30 degrees vertical angle.
+ * \param b
+ * \brief Bench struct.
+ * \param diameter
+ * \brief drop diameter.
+ * \param drag_model
+ * \brief drop drag resistance model.
+ */
+static void
+bench_init (Bench * b, double diameter, unsigned int drag_model)
+{
+  Trajectory *t;
+  Drop *d;
+  t = b->trajectory0;
+  memset (t, 0, sizeof (Trajectory));
+  t->dt = 0.001;
+  t->cfl = 0.1;
+  t->jet_model = TRAJECTORY_JET_MODEL_NULL_DRAG;
+  t->drop_maximum_diameter = MAXIMUM_DROP_DIAMETER;
+  d = t->drop;
+  d->r[2] = 2.;
+  d->v[0] = 20. * cos (M_PI / 6.);
+  d->v[2] = 20. * sin (M_PI / 6.);
+  d->diameter = diameter;
+  d->drag_coefficient = 0.5;
+  d->detach_model = DROP_DETACH_MODEL_TOTAL;
+  d->drag_model = drag_model;
+  drop_init (d, b->air, NULL);
+  memcpy (b->trajectory, t, sizeof (Trajectory));
+}
+
+/**
+ * \fn static void bench_drop_move (Bench * b, unsigned long int n)
+ * \brief function to call drop_move.
+ * \param b
+ * \brief Bench struct.
+ * \param n
+ * \brief number of calls.
+ */
+static void
+bench_drop_move (Bench * b, unsigned long int n)
+{
+  Drop *d;
+  double s;
+  unsigned long int i;
+  d = b->trajectory->drop;
+  for (i = 0, s = 0.; i < n; ++i)
+    {
+      d->v[0] = b->velocity[i % BENCH_VELOCITIES];
+      s += drop_move (d, b->air, 1.);
+    }
+  b->sink += s;
+}
+
+/**
+ * \fn static void bench_drop_drag_sphere (Bench * b, unsigned long int n)
+ * \brief function to call drop_drag_sphere.
+ * \param b
+ * \brief Bench struct.
+ * \param n
+ * \brief number of calls.
+ */
+static void
+bench_drop_drag_sphere (Bench * b, unsigned long int n)
+{
+  Drop *d;
+  double s;
+  unsigned long int i;
+  d = b->trajectory->drop;
+  for (i = 0, s = 0.; i < n; ++i)
+    s += drop_drag_sphere (d, b->air, b->velocity[i % BENCH_VELOCITIES]);
+  b->sink += s;
+}
+
+/**
+ * \fn static void bench_drop_axis_ratio (Bench * b, unsigned long int n)
+ * \brief function to call drop_axis_ratio_Burguete.
+ * \param b
+ * \brief Bench struct.
+ * \param n
+ * \brief number of calls.
+ */
+static void
+bench_drop_axis_ratio (Bench * b, unsigned long int n)
+{
+  Drop *d;
+  double s;
+  unsigned long int i;
+  d = b->trajectory->drop;
+  for (i = 0, s = 0.; i < n; ++i)
+    s += drop_axis_ratio_Burguete (d, b->air,
+                                   b->velocity[i % BENCH_VELOCITIES]);
+  b->sink += s;
+}
+
+/**
+ * \fn static void bench_runge_kutta_4 (Bench * b, unsigned long int n)
+ * \brief function to call trajectory_runge_kutta_4, restarting the drop every
+ *   BENCH_RESET steps.
+ * \param b
+ * \brief Bench struct.
+ * \param n
+ * \brief number of calls.
+ */
+static void
+bench_runge_kutta_4 (Bench * b, unsigned long int n)
+{
+  unsigned long int i;
+  for (i = 0; i < n; ++i)
+    {
+      if (!(i % BENCH_RESET))
+        memcpy (b->trajectory, b->trajectory0, sizeof (Trajectory));
+      trajectory_runge_kutta_4 (b->trajectory, b->air, 1.);
+    }
+  b->sink += b->trajectory->drop->r[0];
+}
+
+/**
+ * \fn static void bench_trajectory_calculate (Bench * b, unsigned long int n)
+ * \brief function to call trajectory_calculate.
+ * \param b
+ * \brief Bench struct.
+ * \param n
+ * \brief number of calls.
+ */
+static void
+bench_trajectory_calculate (Bench * b, unsigned long int n)
+{
+  unsigned long int i;
+  for (i = 0; i < n; ++i)
+    {
+      memcpy (b->trajectory, b->trajectory0, sizeof (Trajectory));
+      trajectory_calculate (b->trajectory, b->air, NULL, 0, NULL);
+      b->sink += b->trajectory->drop->r[0];
+    }
+}
+
+/**
+ * \fn static unsigned long long int bench_counter (unsigned int counter)
+ * \brief function to get an instrumentation counter of the thread, added for
+ *   all the drop diameter classes.
+ * \param counter
+ * \brief counter type (see ::InstrumentCounter).
+ * \return counter value.
+ */
+static unsigned long long int
+bench_counter (unsigned int counter)
+{
+  Instrument *i;
+  unsigned long long int n;
+  unsigned int j;
+  i = instrument_get ();
+  for (j = 0, n = 0; j < INSTRUMENT_CLASSES; ++j)
+    n += i->counter[j][counter];
+  return n;
+}
+
+/**
+ * \fn static double bench_steps (Bench * b)
+ * \brief function to count the integration steps of trajectory_calculate with
+ *   the instrumentation counters.
+ * \param b
+ * \brief Bench struct.
+ * \return number of integration steps.
+ */
+static double
+bench_steps (Bench * b)
+{
+  unsigned long long int n;
+  n = bench_counter (INSTRUMENT_CFL_LIMITED)
+    + bench_counter (INSTRUMENT_DT_LIMITED);
+  memcpy (b->trajectory, b->trajectory0, sizeof (Trajectory));
+  trajectory_calculate (b->trajectory, b->air, NULL, 0, NULL);
+  return (double) (bench_counter (INSTRUMENT_CFL_LIMITED)
+                   + bench_counter (INSTRUMENT_DT_LIMITED) - n);
+}
+
+/**
+ * \fn static double bench_landing (Bench * b, double dt, double cfl, \
+ *   double *r)
+ * \brief function to calculate the landing point of a drop with
+ *   trajectory_calculate, counting the drop_move evaluations with the
+ *   instrumentation counters.
+ * \param b
+ * \brief Bench struct.
+ * \param dt
+ * \brief time step size.
+ * \param cfl
+ * \brief CFL number.
+ * \param r
+ * \brief landing point.
+ * \return number of drop_move evaluations.
+ */
+static double
+bench_landing (Bench * b, double dt, double cfl, double *r)
+{
+  Trajectory *t;
+  unsigned long long int n;
+  t = b->trajectory;
+  memcpy (t, b->trajectory0, sizeof (Trajectory));
+  t->dt = dt;
+  t->cfl = cfl;
+  n = bench_counter (INSTRUMENT_DROP_MOVE);
+  trajectory_calculate (t, b->air, NULL, 0, NULL);
+  r[0] = t->drop->r[0];
+  r[1] = t->drop->r[1];
+  return (double) (bench_counter (INSTRUMENT_DROP_MOVE) - n);
+}
+
+/**
+ * \fn static void bench_accuracy (Bench * b, double tolerance)
+ * \brief function to sweep the time step size and the CFL number of the
+ *   trajectory integration. For every setting the maximum landing point error
+ *   of the drop diameters with respect to a very fine reference and the number
+ *   of drop_move evaluations are reported, marking the Pareto frontier
+ *   settings (no other setting is cheaper and more accurate).
+ * \param b
+ * \brief Bench struct.
+ * \param tolerance
+ * \brief landing point error tolerance to select the cheapest setting or 0 to
+ *   not select it.
+ */
+static void
+bench_accuracy (Bench * b, double tolerance)
+{
+  const double dt[BENCH_DTS]
+    = { 0.1, 0.03, 0.01, 0.003, 0.001, 0.0003, 0.0001 };
+  const double cfl[BENCH_CFLS] = { 1., 0.3, 0.1, 0.03, 0.01, 0.003, 0.001 };
+  BenchSetting setting[BENCH_DTS * BENCH_CFLS], *s, *best;
+  double reference[BENCH_DIAMETERS][2], r[2], evaluations, error;
+  unsigned int i, j, k, n;
+
+  // reference landing points and check of their convergence
+  for (i = 0, error = 0.; i < BENCH_DIAMETERS; ++i)
+    {
+      bench_init (b, bench_diameter[i], DROP_DRAG_MODEL_OVOID);
+      bench_landing (b, BENCH_REFERENCE_DT, BENCH_REFERENCE_CFL,
+                     reference[i]);
+      bench_landing (b, 2. * BENCH_REFERENCE_DT, 2. * BENCH_REFERENCE_CFL, r);
+      error = fmax (error, hypot (r[0] - reference[i][0],
+                                  r[1] - reference[i][1]));
+    }
+  printf ("Reference: dt=%lg cfl=%lg (error with the double values: %.3le m)"
+          "\n", BENCH_REFERENCE_DT, BENCH_REFERENCE_CFL, error);
+
+  // sweep of the settings
+  for (i = n = 0; i < BENCH_DTS; ++i)
+    for (j = 0; j < BENCH_CFLS; ++j, ++n)
+      {
+        s = setting + n;
+        s->dt = dt[i];
+        s->cfl = cfl[j];
+        s->error = s->evaluations = 0.;
+        for (k = 0; k < BENCH_DIAMETERS; ++k)
+          {
+            bench_init (b, bench_diameter[k], DROP_DRAG_MODEL_OVOID);
+            s->evaluations += bench_landing (b, dt[i], cfl[j], r);
+            s->error = fmax (s->error, hypot (r[0] - reference[k][0],
+                                              r[1] - reference[k][1]));
+          }
+      }
+
+  // Pareto frontier
+  for (i = 0; i < n; ++i)
+    {
+      setting[i].pareto = 1;
+      for (j = 0; j < n; ++j)
+        if (setting[j].evaluations <= setting[i].evaluations
+            && setting[j].error <= setting[i].error
+            && (setting[j].evaluations < setting[i].evaluations
+                || setting[j].error < setting[i].error))
+          {
+            setting[i].pareto = 0;
+            break;
+          }
+    }
+  printf ("%10s %10s %14s %14s %s\n", "dt", "cfl", "error (m)",
+          "evaluations", "pareto");
+  for (i = 0; i < n; ++i)
+    printf ("%10lg %10lg %14.4le %14.0lf %s\n", setting[i].dt, setting[i].cfl,
+            setting[i].error, setting[i].evaluations,
+            setting[i].pareto ? "*" : "");
+  printf ("Pareto frontier:\n");
+  for (evaluations = 0.;;)
+    {
+      for (i = 0, best = NULL; i < n; ++i)
+        if (setting[i].pareto && setting[i].evaluations > evaluations
+            && (!best || setting[i].evaluations < best->evaluations))
+          best = setting + i;
+      if (!best)
+        break;
+      printf ("%10lg %10lg %14.4le %14.0lf\n", best->dt, best->cfl,
+              best->error, best->evaluations);
+      evaluations = best->evaluations;
+    }
+
+  // cheapest setting meeting the tolerance
+  if (tolerance <= 0.)
+    return;
+  for (i = 0, best = NULL; i < n; ++i)
+    if (setting[i].error <= tolerance
+        && (!best || setting[i].evaluations < best->evaluations))
+      best = setting + i;
+  if (best)
+    printf ("Cheapest setting with error <= %lg m: dt=%lg cfl=%lg\n",
+            tolerance, best->dt, best->cfl);
+  else
+    printf ("No setting with error <= %lg m\n", tolerance);
+}
+
+/**
+ * \fn static int bench_same (Sprinkler * s, Sprinkler * s1)
+ * \brief function to check if the aggregated drops data and the uniformity
+ *   statistics of two sprinkler runs are identical.
+ * \param s
+ * \brief Sprinkler struct.
+ * \param s1
+ * \brief Sprinkler struct of the one thread run.
+ * \return 1 if identical, 0 otherwise.
+ */
+static int
+bench_same (Sprinkler * s, Sprinkler * s1)
+{
+  Measurement *m, *m1;
+  unsigned int i;
+  if (s->distance != s1->distance || s->volume != s1->volume
+      || s->mean != s1->mean || s->variance != s1->variance
+      || s->cu != s1->cu || s->du != s1->du)
+    return 0;
+  for (i = 0; i < s->nmeasurements; ++i)
+    {
+      m = s->measurement + i;
+      m1 = s1->measurement + i;
+      if (m->volume != m1->volume || m->velocity != m1->velocity
+          || m->weight != m1->weight || m->weight2 != m1->weight2
+          || m->velocity_weight2 != m1->velocity_weight2
+          || m->velocity2 != m1->velocity2 || m->nhits != m1->nhits)
+        return 0;
+    }
+  for (i = 0; i < s->nrings; ++i)
+    if (s->profile[i] != s1->profile[i])
+      return 0;
+  return 1;
+}
+
+/**
+ * \fn static int bench_scaling (char *name, unsigned int nmax)
+ * \brief function to run a sprinkler scenario with 1, 2, 4, ... and nmax
+ *   threads. For every threads number the drops per second, the parallel
+ *   efficiency with respect to one thread, the spread of the busy times of
+ *   the threads, the maximum to mean calculated drops ratio, the chunks
+ *   number and the number of drop ranges stolen between threads are reported,
+ *   checking that the measurements output, the aggregated drops data and the
+ *   uniformity statistics are identical to the ones of the one thread run.
+ * \param name
+ * \brief sprinkler scenario file name.
+ * \param nmax
+ * \brief maximum threads number.
+ * \return 1 if all the outputs are identical, 0 otherwise.
+ */
+static int
+bench_scaling (char *name, unsigned int nmax)
+{
+  Sprinkler s0[1], s[1], s1[1];
+  Air a[1];
+  xmlDoc *doc;
+  FILE *file;
+  char *output, *output1;
+  SprinklerLoad *load;
+  double time, time1, minimum, maximum, mean;
+  gint64 t0;
+  long int size, size1;
+  unsigned int i, n, drops, chunks, steals;
+  int identical, error_code;
+  error_code = 0;
+  xmlKeepBlanksDefault (0);
+  doc = xmlParseFile (name);
+  if (!doc)
+    {
+      printf ("Unable to parse the scenario file\n");
+      return 0;
+    }
+  if (!sprinkler_open_xml (s0, a, xmlDocGetRootElement (doc)))
+    {
+      show_error ();
+      xmlFreeDoc (doc);
+      return 0;
+    }
+  xmlFreeDoc (doc);
+  s0->ntrajectories = MAX (s0->ntrajectories, BENCH_DROPS);
+  nmax = MAX (1, nmax);
+  load = (SprinklerLoad *) g_malloc (nmax * sizeof (SprinklerLoad));
+  output1 = NULL;
+  size1 = 0;
+  time1 = 0.;
+  printf ("Drops: %u\n", s0->ntrajectories);
+  printf ("%8s %12s %10s %10s %10s %10s %8s %9s %8s %8s %s\n", "threads",
+          "drops/s", "efficiency", "busy min", "busy mean", "busy max",
+          "spread", "drops max", "chunks", "steals", "output");
+  for (n = 1;; n = MIN (2 * n, nmax))
+    {
+      sprinkler_copy (s, s0);
+      file = tmpfile ();
+      if (!file)
+        {
+          printf ("Unable to open a temporary file\n");
+          sprinkler_free (s);
+          goto exit_scaling;
+        }
+      t0 = g_get_monotonic_time ();
+      if (!sprinkler_calculate (s, a, file, n, load))
+        {
+          show_error ();
+          fclose (file);
+          sprinkler_free (s);
+          goto exit_scaling;
+        }
+      time = 1e-6 * (g_get_monotonic_time () - t0);
+      if (s->nmeasurements)
+        sprinkler_uniformity (s);
+      size = ftell (file);
+      output = (char *) g_malloc (size + 1);
+      rewind (file);
+      size = fread (output, 1, size, file);
+      fclose (file);
+      if (n == 1)
+        {
+          memcpy (s1, s, sizeof (Sprinkler));
+          output1 = output;
+          size1 = size;
+          time1 = time;
+          identical = 1;
+        }
+      else
+        {
+          identical = (size == size1 && !memcmp (output, output1, size)
+                       && bench_same (s, s1));
+          sprinkler_free (s);
+          g_free (output);
+        }
+      minimum = maximum = mean = load->busy;
+      drops = load->drops;
+      chunks = load->chunks;
+      steals = load->steals;
+      for (i = 1; i < n; ++i)
+        {
+          minimum = fmin (minimum, load[i].busy);
+          maximum = fmax (maximum, load[i].busy);
+          mean += load[i].busy;
+          drops = MAX (drops, load[i].drops);
+          chunks += load[i].chunks;
+          steals += load[i].steals;
+        }
+      mean /= n;
+      printf ("%8u %12.1lf %9.1lf%% %9.3lfs %9.3lfs %9.3lfs %7.1lf%% %8.1lf%% "
+              "%8u %8u %s\n", n, s0->ntrajectories / time,
+              100. * time1 / (n * time), minimum, mean, maximum,
+              100. * (maximum - minimum) / mean,
+              100. * drops * n / s0->ntrajectories, chunks, steals,
+              identical ? "identical" : "DIFFERENT");
+      if (!identical)
+        goto exit_scaling;
+      if (n == nmax)
+        break;
+    }
+  error_code = 1;
+
+exit_scaling:
+  if (output1)
+    sprinkler_free (s1);
+  g_free (output1);
+  g_free (load);
+  sprinkler_free (s0);
+  return error_code;
+}
+
+/**
+ * \fn int main (int argn, char **argc)
+ * \brief main function.
+ * \param argn
+ * \brief arguments number.
+ * \param argc
+ * \brief argument strings.
+ * \return 0 on success, 1 on error.
+ */
+int
+main (int argn, char **argc)
+{
+  const char *model[3] = { "constant", "sphere", "ovoid" };
+  char label[64];
+  Bench b[1];
+  Air *a;
+  unsigned int i;
+  a = b->air;
+  a->temperature = AIR_TEMPERATURE;
+  a->pressure = AIR_PRESSURE;
+  a->humidity = AIR_HUMIDITY;
+  a->velocity = WIND_VELOCITY;
+  a->uncertainty = 0.;
+  a->angle = M_PI / 180. * WIND_ANGLE;
+  a->height = WIND_HEIGHT;
+  air_calculate (a);
+  a->u = a->vx;
+  a->v = a->vy;
+  for (i = 0; i < BENCH_VELOCITIES; ++i)
+    b->velocity[i] = 0.05 * pow (600., i / (BENCH_VELOCITIES - 1.));
+  b->sink = 0.;
+  if (argn > 1 && argn < 4 && !strcmp (argc[1], "-accuracy"))
+    {
+      bench_accuracy (b, argn == 3 ? atof (argc[2]) : 0.);
+      return 0;
+    }
+  if (argn > 2 && argn < 5 && !strcmp (argc[1], "-scaling"))
+    return !bench_scaling (argc[2], argn == 4 ? atoi (argc[3])
+                           : g_get_num_processors ());
+  if (argn > 1)
+    {
+      printf ("Usage of this program is:\n"
+              "\tbench [-accuracy [tolerance]]\n"
+              "or\n"
+              "\tbench -scaling sprinkler_file [maximum_threads]\n");
+      return 1;
+    }
+#if DRAG_SPHERE == DRAG_SPHERE_FUKUI
+  printf ("Sphere drag model: Fukui\n");
+#elif DRAG_SPHERE == DRAG_SPHERE_MORSI_ALEXANDER
+  printf ("Sphere drag model: Morsi-Alexander\n");
+#endif
+  for (i = 0; i < 3; ++i)
+    {
+      bench_init (b, 0.004, i);
+      snprintf (label, 64, "drop_move (%s)", model[i]);
+      bench_measure (label, bench_drop_move, b, 0.);
+    }
+  bench_init (b, 0.004, DROP_DRAG_MODEL_SPHERE);
+  bench_measure ("drop_drag_sphere", bench_drop_drag_sphere, b, 0.);
+  bench_measure ("drop_axis_ratio_Burguete", bench_drop_axis_ratio, b, 0.);
+  for (i = 0; i < 3; ++i)
+    {
+      bench_init (b, 0.004, i);
+      snprintf (label, 64, "trajectory_runge_kutta_4 (%s)", model[i]);
+      bench_measure (label, bench_runge_kutta_4, b, 1.);
+    }
+  for (i = 0; i < BENCH_DIAMETERS; ++i)
+    {
+      bench_init (b, bench_diameter[i], DROP_DRAG_MODEL_OVOID);
+      snprintf (label, 64, "trajectory_calculate (%.1lf mm)",
+                1e3 * bench_diameter[i]);
+      bench_measure (label, bench_trajectory_calculate, b, bench_steps (b));
+    }
+  // prevents the compiler from removing the benchmarked calls
+  if (isnan (b->sink))
+    printf ("NaN results\n");
+  return 0;
+}
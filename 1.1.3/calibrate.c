@@ -0,0 +1,816 @@
+/*
+Sprinkler: a software to calculate drop trajectories in sprinkler irrigation.
+
+AUTHORS: Javier Burguete.
+
+Copyright 2012-2015, AUTHORS.
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+	1. Redistributions of source code must retain the above copyright notice,
+		this list of conditions and the following disclaimer.
+
+	2. Redistributions in binary form must reproduce the above copyright notice,
+		this list of conditions and the following disclaimer in the
+		documentation and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY AUTHORS ``AS IS'' AND ANY EXPRESS OR IMPLIED
+WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+SHALL AUTHORS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+
+/**
+ * \file calibrate.c
+ * \brief Source file to calibrate the model parameters with a surrogate
+ *   assisted algorithm.
+ * \author Javier Burguete Tolosa.
+ * \copyright Copyright 2012-2015 Javier Burguete Tolosa, all rights reserved.
+ */
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <float.h>
+#include <math.h>
+#include <unistd.h>
+#include <libxml/parser.h>
+#include <glib.h>
+#include <libintl.h>
+#include <gsl/gsl_rng.h>
+#include <gsl/gsl_randist.h>
+#include <gsl/gsl_linalg.h>
+#include "config.h"
+#include "utils.h"
+#include "air.h"
+#include "drop.h"
+#include "measurement.h"
+#include "trajectory.h"
+#include "sprinkler.h"
+#include "objective.h"
+#include "calibrate.h"
+
+#define DEBUG_CALIBRATE 0       ///< macro to debug calibrate functions.
+
+#define CALIBRATE_SCALE 0.01
+///< scale factor of the experimental profiles (cm to m as in the evaluator).
+#define CALIBRATE_DISTANCE 1e-6
+///< minimum normalized distance between a candidate and an evaluated point.
+#define CALIBRATE_SIGMA 0.1
+///< normalized standard deviation of the candidates around the best point.
+
+/**
+ * \var calibrate_weight
+ * \brief cycle of weights of the surrogate value respect to the distance to
+ *   the evaluated points to select the candidates.
+ */
+static const double calibrate_weight[4] = { 0.3, 0.5, 0.8, 0.95 };
+
+/**
+ * \fn void calibrate_error (char *message)
+ * \brief function to show an error message opening a Calibrate struct.
+ * \param message
+ * \brief error message.
+ */
+void
+calibrate_error (char *message)
+{
+  error_message = g_strconcat (gettext ("Calibrate"), ": ", message, NULL);
+}
+
+/**
+ * \fn void calibrate_free (Calibrate * c)
+ * \brief function to free the memory used by a Calibrate struct.
+ * \param c
+ * \brief Calibrate struct.
+ */
+void
+calibrate_free (Calibrate * c)
+{
+  unsigned int i;
+  for (i = 0; i < c->nvariables; ++i)
+    xmlFree (c->name[i]);
+  g_free (c->name);
+  g_free (c->minimum);
+  g_free (c->maximum);
+  g_free (c->precision);
+  g_free (c->x);
+  g_free (c->f);
+  g_free (c->template);
+  xmlFree (c->trajectory);
+  xmlFree (c->state);
+  objective_free (c->objective);
+  c->name = NULL;
+  c->minimum = c->maximum = c->x = c->f = NULL;
+  c->precision = NULL;
+  c->template = c->trajectory = c->state = NULL;
+  c->nvariables = c->nevaluated = 0;
+}
+
+/**
+ * \fn int calibrate_open_xml (Calibrate * c, xmlNode * node)
+ * \brief function to open a Calibrate struct on a XML node.
+ * \param c
+ * \brief Calibrate struct.
+ * \param node
+ * \brief XML node.
+ * \return 1 on success, 0 on error.
+ */
+int
+calibrate_open_xml (Calibrate * c, xmlNode * node)
+{
+  xmlChar *buffer;
+  unsigned int i, monte_carlo;
+  int k;
+#if DEBUG_CALIBRATE
+  fprintf (stderr, "calibrate_open_xml: start\n");
+#endif
+  c->name = NULL;
+  c->minimum = c->maximum = c->x = c->f = NULL;
+  c->precision = NULL;
+  c->template = c->trajectory = c->state = NULL;
+  c->objective->point = NULL;
+  c->objective->npoints = 0;
+  c->nvariables = c->nevaluated = 0;
+  if (xmlStrcmp (node->name, XML_CALIBRATE))
+    {
+      calibrate_error (gettext ("bad label"));
+      goto exit_on_error;
+    }
+  buffer = xmlGetProp (node, XML_ALGORITHM);
+  if (!buffer || !xmlStrcmp (buffer, XML_SURROGATE))
+    monte_carlo = 0;
+  else if (!xmlStrcmp (buffer, XML_MONTE_CARLO))
+    monte_carlo = 1;
+  else
+    {
+      calibrate_error (gettext ("unknown algorithm"));
+      xmlFree (buffer);
+      goto exit_on_error;
+    }
+  xmlFree (buffer);
+  c->nsimulations
+    = xml_node_get_uint_with_default (node, XML_NSIMULATIONS, 0, &k);
+  if (!k || !c->nsimulations)
+    {
+      calibrate_error (gettext ("bad simulations number"));
+      goto exit_on_error;
+    }
+  c->ninitial = xml_node_get_uint_with_default (node, XML_NINITIAL, 0, &k);
+  if (!k)
+    {
+      calibrate_error (gettext ("bad initial simulations number"));
+      goto exit_on_error;
+    }
+  c->ncandidates
+    = xml_node_get_uint_with_default (node, XML_NCANDIDATES, 1000, &k);
+  if (!k || !c->ncandidates)
+    {
+      calibrate_error (gettext ("bad candidates number"));
+      goto exit_on_error;
+    }
+  c->state = (char *) xmlGetProp (node, XML_STATE);
+  node = node->children;
+  if (!node || xmlStrcmp (node->name, XML_EXPERIMENT))
+    {
+      calibrate_error (gettext ("no experiment"));
+      goto exit_on_error;
+    }
+  buffer = xmlGetProp (node, XML_NAME);
+  if (!buffer)
+    {
+      calibrate_error (gettext ("no experiment name"));
+      goto exit_on_error;
+    }
+  k = objective_open_profile (c->objective, (char *) buffer, CALIBRATE_SCALE);
+  xmlFree (buffer);
+  if (!k)
+    {
+      calibrate_error (gettext ("unable to open the experiment"));
+      goto exit_on_error;
+    }
+  buffer = xmlGetProp (node, XML_TEMPLATE1);
+  if (!buffer)
+    {
+      calibrate_error (gettext ("no template"));
+      goto exit_on_error;
+    }
+  k = g_file_get_contents ((char *) buffer, &c->template, NULL, NULL);
+  xmlFree (buffer);
+  if (!k)
+    {
+      calibrate_error (gettext ("unable to open the template"));
+      goto exit_on_error;
+    }
+  c->trajectory = (char *) xmlGetProp (node, XML_TRAJECTORY);
+  if (!c->trajectory)
+    c->trajectory = (char *) xmlStrdup ((const xmlChar *) "vyr");
+  for (node = node->next; node; node = node->next)
+    {
+      if (xmlStrcmp (node->name, XML_VARIABLE))
+        {
+          calibrate_error (gettext ("bad variable label"));
+          goto exit_on_error;
+        }
+      i = c->nvariables;
+      c->name = (char **) g_realloc (c->name, (i + 1) * sizeof (char *));
+      c->minimum = (double *) g_realloc (c->minimum, (i + 1) * sizeof (double));
+      c->maximum = (double *) g_realloc (c->maximum, (i + 1) * sizeof (double));
+      c->precision = (unsigned int *)
+        g_realloc (c->precision, (i + 1) * sizeof (unsigned int));
+      c->name[i] = (char *) xmlGetProp (node, XML_NAME);
+      ++c->nvariables;
+      if (!c->name[i])
+        {
+          calibrate_error (gettext ("no variable name"));
+          goto exit_on_error;
+        }
+      c->minimum[i] = xml_node_get_float (node, XML_MINIMUM, &k);
+      if (!k)
+        {
+          calibrate_error (gettext ("bad minimum"));
+          goto exit_on_error;
+        }
+      c->maximum[i] = xml_node_get_float (node, XML_MAXIMUM, &k);
+      if (!k || c->maximum[i] <= c->minimum[i])
+        {
+          calibrate_error (gettext ("bad maximum"));
+          goto exit_on_error;
+        }
+      c->precision[i]
+        = xml_node_get_uint_with_default (node, XML_PRECISION, 14, &k);
+      if (!k)
+        {
+          calibrate_error (gettext ("bad precision"));
+          goto exit_on_error;
+        }
+    }
+  if (!c->nvariables)
+    {
+      calibrate_error (gettext ("no variables"));
+      goto exit_on_error;
+    }
+
+  // the Monte-Carlo algorithm only samples the initial design, the surrogate
+  // needs at least nvariables + 1 initial points
+  if (monte_carlo)
+    c->ninitial = c->nsimulations;
+  else if (!c->ninitial)
+    c->ninitial = 2 * (c->nvariables + 1);
+  else if (c->ninitial <= c->nvariables)
+    {
+      calibrate_error (gettext ("bad initial simulations number"));
+      goto exit_on_error;
+    }
+  c->ninitial = MIN (c->ninitial, c->nsimulations);
+  c->x = (double *)
+    g_malloc (c->nsimulations * c->nvariables * sizeof (double));
+  c->f = (double *) g_malloc (c->nsimulations * sizeof (double));
+
+#if DEBUG_CALIBRATE
+  fprintf (stderr, "calibrate_open_xml: end\n");
+#endif
+  return 1;
+
+exit_on_error:
+  calibrate_free (c);
+#if DEBUG_CALIBRATE
+  fprintf (stderr, "calibrate_open_xml: end\n");
+#endif
+  return 0;
+}
+
+/**
+ * \fn int calibrate_open_state (Calibrate * c)
+ * \brief function to read the simulations evaluated in a previous calibration
+ *   saved in the state file.
+ * \param c
+ * \brief Calibrate struct.
+ * \return 1 on success, 0 on error.
+ */
+int
+calibrate_open_state (Calibrate * c)
+{
+  FILE *file;
+  double *x;
+  unsigned int i;
+#if DEBUG_CALIBRATE
+  fprintf (stderr, "calibrate_open_state: start\n");
+#endif
+  if (!c->state)
+    goto exit_state;
+  file = fopen (c->state, "r");
+  if (!file)
+    goto exit_state;
+  while (c->nevaluated < c->nsimulations)
+    {
+      x = c->x + c->nevaluated * c->nvariables;
+      for (i = 0; i < c->nvariables; ++i)
+        {
+          if (fscanf (file, "%lf", x + i) != 1)
+            goto exit_file;
+          x[i] = (x[i] - c->minimum[i]) / (c->maximum[i] - c->minimum[i]);
+        }
+      if (fscanf (file, "%lf", c->f + c->nevaluated) != 1)
+        goto exit_file;
+      ++c->nevaluated;
+    }
+
+exit_file:
+  if (!feof (file) && c->nevaluated < c->nsimulations)
+    {
+      fclose (file);
+      calibrate_error (gettext ("bad state file"));
+#if DEBUG_CALIBRATE
+      fprintf (stderr, "calibrate_open_state: end\n");
+#endif
+      return 0;
+    }
+  fclose (file);
+
+exit_state:
+#if DEBUG_CALIBRATE
+  fprintf (stderr, "calibrate_open_state: nevaluated=%u\n", c->nevaluated);
+  fprintf (stderr, "calibrate_open_state: end\n");
+#endif
+  return 1;
+}
+
+/**
+ * \fn int calibrate_save_state (Calibrate * c, unsigned int i)
+ * \brief function to append an evaluated simulation to the state file.
+ * \param c
+ * \brief Calibrate struct.
+ * \param i
+ * \brief simulation number.
+ * \return 1 on success, 0 on error.
+ */
+int
+calibrate_save_state (Calibrate * c, unsigned int i)
+{
+  FILE *file;
+  double *x;
+  unsigned int j;
+  if (!c->state)
+    return 1;
+  file = fopen (c->state, "a");
+  if (!file)
+    {
+      calibrate_error (gettext ("unable to open the state file"));
+      return 0;
+    }
+  x = c->x + i * c->nvariables;
+  for (j = 0; j < c->nvariables; ++j)
+    fprintf (file, "%.*lf ", c->precision[j],
+             c->minimum[j] + x[j] * (c->maximum[j] - c->minimum[j]));
+  fprintf (file, "%.14le\n", c->f[i]);
+  fclose (file);
+  return 1;
+}
+
+/**
+ * \fn int calibrate_simulation (Calibrate * c, double *x, char *result, \
+ *   double *f)
+ * \brief function to run a full simulation from the input file template and
+ *   to evaluate its objective function. The variables are rounded to their
+ *   precision digits as written on the input file.
+ * \param c
+ * \brief Calibrate struct.
+ * \param x
+ * \brief array of normalized variables.
+ * \param result
+ * \brief results file name.
+ * \param f
+ * \brief pointer to the objective function value.
+ * \return 1 on success, 0 on error.
+ */
+int
+calibrate_simulation (Calibrate * c, double *x, char *result, double *f)
+{
+  Sprinkler sprinkler[1];
+  Air air[1];
+  Trajectory trajectory[1];
+  GString *input;
+  xmlDoc *doc;
+  xmlNode *node;
+  FILE *file;
+  char *p, *q, *name, *trajectory_name;
+  double t[9], value;
+  unsigned int i;
+  int k;
+#if DEBUG_CALIBRATE
+  fprintf (stderr, "calibrate_simulation: start\n");
+#endif
+  k = 0;
+
+  // replacing the @variableN@ and @valueN@ template labels
+  input = g_string_new (NULL);
+  for (p = c->template; (q = strchr (p, '@')); p = q + 1)
+    {
+      g_string_append_len (input, p, q - p);
+      if (sscanf (q, "@variable%u@", &i) == 1 && i > 0 && i <= c->nvariables)
+        g_string_append (input, c->name[i - 1]);
+      else if (sscanf (q, "@value%u@", &i) == 1 && i > 0
+               && i <= c->nvariables)
+        {
+          --i;
+          value = c->minimum[i] + x[i] * (c->maximum[i] - c->minimum[i]);
+          name = g_strdup_printf ("%.*lf", c->precision[i], value);
+          g_string_append (input, name);
+          x[i] = (atof (name) - c->minimum[i])
+            / (c->maximum[i] - c->minimum[i]);
+          g_free (name);
+        }
+      else
+        {
+          g_string_append_len (input, q, 1);
+          continue;
+        }
+      q = strchr (q + 1, '@');
+      if (!q)
+        {
+          p = "";
+          break;
+        }
+    }
+  if (!q)
+    g_string_append (input, p);
+
+  // running the simulation
+  doc = xmlParseMemory (input->str, input->len);
+  g_string_free (input, TRUE);
+  if (!doc)
+    {
+      calibrate_error (gettext ("unable to parse the template"));
+      goto exit_simulation;
+    }
+  node = xmlDocGetRootElement (doc);
+  if (!node || xmlStrcmp (node->name, XML_SPRINKLER))
+    {
+      xmlFreeDoc (doc);
+      calibrate_error (gettext ("bad template"));
+      goto exit_simulation;
+    }
+  name = g_strconcat (result, "-simulation", NULL);
+  k = sprinkler_run_xml (sprinkler, air, trajectory, node, name);
+  xmlFreeDoc (doc);
+  if (!k)
+    {
+      // the simulation error is kept as the cause
+      g_free (name);
+      name = error_message;
+      calibrate_error (name);
+      g_free (name);
+      goto exit_simulation;
+    }
+
+  // evaluating the objective function
+  trajectory_name = g_strconcat (name, "-", c->trajectory, NULL);
+  objective_init (c->objective);
+  file = fopen (trajectory_name, "r");
+  if (file)
+    {
+      while (fscanf (file, "%lf%lf%lf%lf%lf%lf%lf%lf%lf", t, t + 1, t + 2,
+                     t + 3, t + 4, t + 5, t + 6, t + 7, t + 8) == 9)
+        objective_add (c->objective, t[1], t[3]);
+      fclose (file);
+      unlink (trajectory_name);
+    }
+  *f = objective_error (c->objective);
+  unlink (name);
+  g_free (trajectory_name);
+  g_free (name);
+
+exit_simulation:
+#if DEBUG_CALIBRATE
+  fprintf (stderr, "calibrate_simulation: end\n");
+#endif
+  return k;
+}
+
+/**
+ * \fn int calibrate_surrogate (Calibrate * c, gsl_vector * w)
+ * \brief function to fit a cubic radial basis function surrogate with a linear
+ *   tail to the logarithm of the evaluated objective function values.
+ * \param c
+ * \brief Calibrate struct.
+ * \param w
+ * \brief GSL vector of the surrogate weights, sized for the maximum number of
+ *   simulations (only the first nevaluated + nvariables + 1 are set).
+ * \return 1 on success, 0 on a singular system.
+ */
+int
+calibrate_surrogate (Calibrate * c, gsl_vector * w)
+{
+  gsl_vector_view v;
+  gsl_matrix *m;
+  gsl_vector *b;
+  gsl_permutation *p;
+  double *xi, *xj;
+  double r, fbig;
+  unsigned int i, j, k, n, nv;
+  int s;
+#if DEBUG_CALIBRATE
+  fprintf (stderr, "calibrate_surrogate: start\n");
+#endif
+  nv = c->nvariables;
+  n = c->nevaluated + nv + 1;
+  m = gsl_matrix_alloc (n, n);
+  b = gsl_vector_alloc (n);
+  p = gsl_permutation_alloc (n);
+  fbig = 0.;
+  for (i = 0; i < c->nevaluated; ++i)
+    if (isfinite (c->f[i]))
+      fbig = fmax (fbig, c->f[i]);
+  for (i = 0; i < n; ++i)
+    {
+      for (j = 0; j < n; ++j)
+        gsl_matrix_set (m, i, j, 0.);
+      gsl_vector_set (b, i, 0.);
+    }
+  for (i = 0; i < c->nevaluated; ++i)
+    {
+      xi = c->x + i * nv;
+      for (j = 0; j < c->nevaluated; ++j)
+        {
+          xj = c->x + j * nv;
+          for (k = 0, r = 0.; k < nv; ++k)
+            r += (xi[k] - xj[k]) * (xi[k] - xj[k]);
+          r = sqrt (r);
+          gsl_matrix_set (m, i, j, r * r * r);
+        }
+      gsl_matrix_set (m, i, c->nevaluated, 1.);
+      gsl_matrix_set (m, c->nevaluated, i, 1.);
+      for (k = 0; k < nv; ++k)
+        {
+          gsl_matrix_set (m, i, c->nevaluated + 1 + k, xi[k]);
+          gsl_matrix_set (m, c->nevaluated + 1 + k, i, xi[k]);
+        }
+      r = isfinite (c->f[i]) ? c->f[i] : fbig;
+      gsl_vector_set (b, i, log (r + DBL_EPSILON * fbig + DBL_MIN));
+    }
+  gsl_linalg_LU_decomp (m, p, &s);
+  for (i = 0; i < n; ++i)
+    if (gsl_matrix_get (m, i, i) == 0.)
+      break;
+  s = (i == n);
+  if (s)
+    {
+      v = gsl_vector_subvector (w, 0, n);
+      gsl_linalg_LU_solve (m, p, b, &v.vector);
+    }
+  gsl_permutation_free (p);
+  gsl_vector_free (b);
+  gsl_matrix_free (m);
+#if DEBUG_CALIBRATE
+  fprintf (stderr, "calibrate_surrogate: end\n");
+#endif
+  return s;
+}
+
+/**
+ * \fn double calibrate_surrogate_value (Calibrate * c, gsl_vector * w, \
+ *   double *x)
+ * \brief function to evaluate the surrogate.
+ * \param c
+ * \brief Calibrate struct.
+ * \param w
+ * \brief GSL vector of the surrogate weights.
+ * \param x
+ * \brief array of normalized variables.
+ * \return surrogate value.
+ */
+double
+calibrate_surrogate_value (Calibrate * c, gsl_vector * w, double *x)
+{
+  double *xi;
+  double r, s;
+  unsigned int i, k, nv;
+  nv = c->nvariables;
+  s = gsl_vector_get (w, c->nevaluated);
+  for (k = 0; k < nv; ++k)
+    s += gsl_vector_get (w, c->nevaluated + 1 + k) * x[k];
+  for (i = 0; i < c->nevaluated; ++i)
+    {
+      xi = c->x + i * nv;
+      for (k = 0, r = 0.; k < nv; ++k)
+        r += (xi[k] - x[k]) * (xi[k] - x[k]);
+      r = sqrt (r);
+      s += gsl_vector_get (w, i) * r * r * r;
+    }
+  return s;
+}
+
+/**
+ * \fn void calibrate_candidate (Calibrate * c, gsl_vector * w, \
+ *   gsl_rng * rng, unsigned int iteration, double *x)
+ * \brief function to select the next point to simulate. Random candidates are
+ *   generated in the whole domain and around the best evaluated point. Every
+ *   candidate is scored weighting its surrogate value (promising) with its
+ *   distance to the evaluated points (uncertain) and the best scored is
+ *   selected.
+ * \param c
+ * \brief Calibrate struct.
+ * \param w
+ * \brief GSL vector of the surrogate weights or NULL if the surrogate could
+ *   not be fitted.
+ * \param rng
+ * \brief GSL pseudo-random numbers generator struct.
+ * \param iteration
+ * \brief iteration number.
+ * \param x
+ * \brief array of normalized variables of the selected point.
+ */
+void
+calibrate_candidate (Calibrate * c, gsl_vector * w, gsl_rng * rng,
+                     unsigned int iteration, double *x)
+{
+  double *y, *s, *d, *best, *xi;
+  double r, smin, smax, dmin, dmax, score, score_min, weight;
+  unsigned int i, j, k, nv, jbest;
+#if DEBUG_CALIBRATE
+  fprintf (stderr, "calibrate_candidate: start\n");
+#endif
+  nv = c->nvariables;
+  y = (double *) g_malloc (c->ncandidates * nv * sizeof (double));
+  s = (double *) g_malloc (c->ncandidates * sizeof (double));
+  d = (double *) g_malloc (c->ncandidates * sizeof (double));
+  for (i = j = 0; i < c->nevaluated; ++i)
+    if (c->f[i] < c->f[j])
+      j = i;
+  best = c->x + j * nv;
+  smin = dmin = INFINITY;
+  smax = dmax = -INFINITY;
+  for (j = 0; j < c->ncandidates; ++j)
+    {
+      for (k = 0; k < nv; ++k)
+        {
+          if (j & 1)
+            r = gsl_rng_uniform (rng);
+          else
+            r = best[k] + gsl_ran_gaussian (rng, CALIBRATE_SIGMA);
+          y[j * nv + k] = fmin (1., fmax (0., r));
+        }
+      d[j] = INFINITY;
+      for (i = 0; i < c->nevaluated; ++i)
+        {
+          xi = c->x + i * nv;
+          for (k = 0, r = 0.; k < nv; ++k)
+            r += (xi[k] - y[j * nv + k]) * (xi[k] - y[j * nv + k]);
+          d[j] = fmin (d[j], sqrt (r));
+        }
+      s[j] = w ? calibrate_surrogate_value (c, w, y + j * nv) : 0.;
+      smin = fmin (smin, s[j]);
+      smax = fmax (smax, s[j]);
+      dmin = fmin (dmin, d[j]);
+      dmax = fmax (dmax, d[j]);
+    }
+  weight = w ? calibrate_weight[iteration % 4] : 0.;
+  score_min = INFINITY;
+  jbest = 0;
+  for (j = 0; j < c->ncandidates; ++j)
+    {
+      if (d[j] < CALIBRATE_DISTANCE)
+        continue;
+      score = 0.;
+      if (smax > smin)
+        score += weight * (s[j] - smin) / (smax - smin);
+      if (dmax > dmin)
+        score += (1. - weight) * (dmax - d[j]) / (dmax - dmin);
+      if (score < score_min)
+        {
+          score_min = score;
+          jbest = j;
+        }
+    }
+  memcpy (x, y + jbest * nv, nv * sizeof (double));
+  g_free (d);
+  g_free (s);
+  g_free (y);
+#if DEBUG_CALIBRATE
+  fprintf (stderr, "calibrate_candidate: end\n");
+#endif
+}
+
+/**
+ * \fn int calibrate_run_xml (Calibrate * c, xmlNode * node, char *result)
+ * \brief function to run a calibration on a XML node. The initial points are
+ *   a latin hypercube design. Next, every iteration fits the surrogate to the
+ *   evaluated simulations and runs a full simulation only on the selected
+ *   candidate. Every simulation is appended to the state file and every
+ *   iteration has its own pseudo-random numbers seed, so an interrupted
+ *   calibration is resumed with the same results.
+ * \param c
+ * \brief Calibrate struct.
+ * \param node
+ * \brief XML node.
+ * \param result
+ * \brief results file name.
+ * \return 1 on success, 0 on error.
+ */
+int
+calibrate_run_xml (Calibrate * c, xmlNode * node, char *result)
+{
+  gsl_rng *rng;
+  gsl_vector *w;
+  FILE *file;
+  double *design, *x;
+  unsigned int *permutation;
+  unsigned int i, j, k, k2, nv;
+  int error_code;
+#if DEBUG_CALIBRATE
+  fprintf (stderr, "calibrate_run_xml: start\n");
+#endif
+  error_code = 0;
+  if (!calibrate_open_xml (c, node))
+    goto exit_run;
+  if (!calibrate_open_state (c))
+    goto exit_free;
+  nv = c->nvariables;
+
+  // latin hypercube initial design
+  rng = gsl_rng_alloc (gsl_rng_taus);
+  gsl_rng_set (rng, RANDOM_SEED);
+  design = (double *) g_malloc (c->ninitial * nv * sizeof (double));
+  permutation = (unsigned int *) g_malloc (c->ninitial * sizeof (unsigned int));
+  for (k = 0; k < nv; ++k)
+    {
+      for (i = 0; i < c->ninitial; ++i)
+        permutation[i] = i;
+      for (i = c->ninitial; i > 1; --i)
+        {
+          j = gsl_rng_uniform_int (rng, i);
+          k2 = permutation[i - 1];
+          permutation[i - 1] = permutation[j];
+          permutation[j] = k2;
+        }
+      for (i = 0; i < c->ninitial; ++i)
+        design[i * nv + k]
+          = (permutation[i] + gsl_rng_uniform (rng)) / c->ninitial;
+    }
+  g_free (permutation);
+
+  // simulations
+  w = gsl_vector_alloc (c->nsimulations + nv + 1);
+  for (i = c->nevaluated; i < c->nsimulations; ++i)
+    {
+      x = c->x + i * nv;
+      if (i < c->ninitial)
+        memcpy (x, design + i * nv, nv * sizeof (double));
+      else
+        {
+          gsl_rng_set (rng, random_seed (RANDOM_SEED, i));
+          calibrate_candidate (c, calibrate_surrogate (c, w) ? w : NULL, rng,
+                               i - c->ninitial, x);
+        }
+      if (!calibrate_simulation (c, x, result, c->f + i))
+        goto exit_simulations;
+      ++c->nevaluated;
+      if (!calibrate_save_state (c, i))
+        goto exit_simulations;
+#if DEBUG_CALIBRATE
+      fprintf (stderr, "calibrate_run_xml: simulation=%u objective=%le\n", i,
+               c->f[i]);
+#endif
+    }
+
+  // best simulation
+  for (i = j = 0; i < c->nevaluated; ++i)
+    if (c->f[i] < c->f[j])
+      j = i;
+  file = fopen (result, "w");
+  if (!file)
+    {
+      calibrate_error (gettext ("unable to open the results file"));
+      goto exit_simulations;
+    }
+  x = c->x + j * nv;
+  for (k = 0; k < nv; ++k)
+    fprintf (file, "%s %.*lf\n", c->name[k], c->precision[k],
+             c->minimum[k] + x[k] * (c->maximum[k] - c->minimum[k]));
+  fprintf (file, "objective %.14le\n", c->f[j]);
+  fclose (file);
+  error_code = 1;
+
+exit_simulations:
+  gsl_vector_free (w);
+  g_free (design);
+  gsl_rng_free (rng);
+
+exit_free:
+  calibrate_free (c);
+
+exit_run:
+#if DEBUG_CALIBRATE
+  fprintf (stderr, "calibrate_run_xml: end\n");
+#endif
+  return error_code;
+}
@@ -0,0 +1,77 @@
+/*
+Sprinkler: a software to calculate drop trajectories in sprinkler irrigation.
+
+AUTHORS: Javier Burguete.
+
+Copyright 2012-2015, AUTHORS.
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+	1. Redistributions of source code must retain the above copyright notice,
+		this list of conditions and the following disclaimer.
+
+	2. Redistributions in binary form must reproduce the above copyright notice,
+		this list of conditions and the following disclaimer in the
+		documentation and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY AUTHORS ``AS IS'' AND ANY EXPRESS OR IMPLIED
+WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+SHALL AUTHORS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+
+/**
+ * \file calibrate.h
+ * \brief Header file to calibrate the model parameters with a surrogate
+ *   assisted algorithm.
+ * \author Javier Burguete Tolosa.
+ * \copyright Copyright 2012-2015 Javier Burguete Tolosa, all rights reserved.
+ */
+#ifndef CALIBRATE__H
+#define CALIBRATE__H 1
+
+/**
+ * \struct Calibrate
+ * \brief struct to define a surrogate assisted calibration.
+ */
+typedef struct
+{
+  Objective objective[1];       ///< Objective struct.
+  char *template;               ///< input file template.
+  char *trajectory;             ///< simulated trajectory file suffix.
+  char *state;                  ///< file name to save the calibration state.
+  char **name;                  ///< array of variable names.
+  double *minimum;              ///< array of variable minimum values.
+  double *maximum;              ///< array of variable maximum values.
+  double *x;
+  ///< array of evaluated points in normalized [0,1] coordinates.
+  double *f;                    ///< array of evaluated objective values.
+  unsigned int *precision;      ///< array of variable precision digits.
+  unsigned int nvariables;      ///< number of variables.
+  unsigned int nsimulations;    ///< maximum number of simulations.
+  unsigned int ninitial;        ///< number of initial design simulations.
+  unsigned int ncandidates;     ///< number of candidates per iteration.
+  unsigned int nevaluated;      ///< number of evaluated simulations.
+} Calibrate;
+
+void calibrate_error (char *message);
+void calibrate_free (Calibrate * c);
+int calibrate_open_xml (Calibrate * c, xmlNode * node);
+int calibrate_open_state (Calibrate * c);
+int calibrate_save_state (Calibrate * c, unsigned int i);
+int calibrate_simulation (Calibrate * c, double *x, char *result, double *f);
+int calibrate_surrogate (Calibrate * c, gsl_vector * w);
+double calibrate_surrogate_value (Calibrate * c, gsl_vector * w, double *x);
+void calibrate_candidate (Calibrate * c, gsl_vector * w, gsl_rng * rng,
+                          unsigned int iteration, double *x);
+int calibrate_run_xml (Calibrate * c, xmlNode * node, char *result);
+
+#endif
@@ -0,0 +1,724 @@
+/*
+Sprinkler: a software to calculate drop trajectories in sprinkler irrigation.
+
+AUTHORS: Javier Burguete.
+
+Copyright 2012-2015, AUTHORS.
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+	1. Redistributions of source code must retain the above copyright notice,
+		this list of conditions and the following disclaimer.
+
+	2. Redistributions in binary form must reproduce the above copyright notice,
+		this list of conditions and the following disclaimer in the
+		documentation and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY AUTHORS ``AS IS'' AND ANY EXPRESS OR IMPLIED
+WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+SHALL AUTHORS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+
+/**
+ * \file compare.c
+ * \brief File to compare simulation results with stored reference results
+ *   using a tolerance for every physical quantity. Nine kinds of results are
+ *   compared:
+ *   - trajectory: trajectory files, interpolating the result at the times of
+ *     the reference and comparing also the landing points;
+ *   - landing: drop batch results, row by row;
+ *   - collectors: collector measurements, comparing the weighted number of
+ *     hits, the volume, the mean diameter and the mean velocity of every
+ *     collector;
+ *   - uniformity: uniformity statistics of the collector depths;
+ *   - calibration: calibrated variables and objective function value, row by
+ *     row, every row preceded by its name;
+ *   - profile: radial profile of the depths, ring by ring;
+ *   - grid: radial pattern rotated on a 2D grid, or overlapped pattern of a
+ *     layout, point by point;
+ *   - layout: uniformity statistics of every layout spacing, row by row;
+ *   - sweep: summary of a sweep of one variable, case by case, every row
+ *     preceded by its label.
+ *   The lines starting with # are skipped.
+ * \author Javier Burguete Tolosa.
+ * \copyright Copyright 2012-2015 Javier Burguete Tolosa, all rights reserved.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#define TRAJECTORY_COLUMNS 9
+///< number of columns of trajectory and drop batch files.
+#define COLLECTOR_COLUMNS 8     ///< number of columns of measurement files.
+#define COLLECTOR_QUANTITIES 4  ///< number of compared collector quantities.
+#define UNIFORMITY_COLUMNS 4    ///< number of columns of uniformity files.
+#define CALIBRATION_COLUMNS 1   ///< number of columns of calibration files.
+#define PROFILE_COLUMNS 2       ///< number of columns of radial profile files.
+#define GRID_COLUMNS 3          ///< number of columns of radial grid files.
+#define LAYOUT_COLUMNS 6        ///< number of columns of layout files.
+#define SWEEP_COLUMNS 6
+///< number of columns of sweep files of one variable, without the label.
+
+/**
+ * \struct Tolerance
+ * \brief struct to define the tolerance of a quantity. A value v is accepted
+ *   if |v - v_reference| <= absolute + relative * |v_reference|.
+ */
+typedef struct
+{
+  const char *name;             ///< quantity name.
+  double absolute;              ///< absolute tolerance.
+  double relative;              ///< relative tolerance.
+} Tolerance;
+
+/**
+ * \struct Comparison
+ * \brief struct to define the comparison of a quantity.
+ */
+typedef struct
+{
+  const Tolerance *tolerance;   ///< quantity tolerance.
+  double error;                 ///< maximum error.
+  double where;                 ///< abscissa of the maximum error.
+  unsigned int ncompared;       ///< number of compared values.
+  unsigned int nfailed;         ///< number of values out of tolerance.
+} Comparison;
+
+/**
+ * \struct Table
+ * \brief struct to define a table of numbers read from a file.
+ */
+typedef struct
+{
+  double *data;                 ///< array of data by rows.
+  unsigned int nrows;           ///< number of rows.
+  unsigned int ncolumns;        ///< number of columns.
+} Table;
+
+/**
+ * \var tolerance_trajectory
+ * \brief tolerances of the trajectory values interpolated at the reference
+ *   times.
+ */
+static const Tolerance tolerance_trajectory[TRAJECTORY_COLUMNS] = {
+  {"time", 0., 0.},
+  {"x", 1e-3, 0.},
+  {"y", 1e-3, 0.},
+  {"z", 1e-3, 0.},
+  {"x velocity", 1e-3, 1e-3},
+  {"y velocity", 1e-3, 1e-3},
+  {"z velocity", 1e-3, 1e-3},
+  {"axis ratio", 1e-3, 0.},
+  {"diameter", 1e-9, 1e-5}
+};
+
+/**
+ * \var tolerance_landing
+ * \brief tolerances of the landing points.
+ */
+static const Tolerance tolerance_landing[TRAJECTORY_COLUMNS] = {
+  {"landing time", 1e-3, 1e-3},
+  {"landing x", 5e-3, 0.},
+  {"landing y", 5e-3, 0.},
+  {"landing z", 5e-3, 0.},
+  {"landing x velocity", 5e-3, 1e-3},
+  {"landing y velocity", 5e-3, 1e-3},
+  {"landing z velocity", 5e-3, 1e-3},
+  {"landing axis ratio", 1e-3, 0.},
+  {"landing diameter", 1e-9, 1e-5}
+};
+
+/**
+ * \var tolerance_collector
+ * \brief tolerances of the collector statistics.
+ */
+static const Tolerance tolerance_collector[COLLECTOR_QUANTITIES] = {
+  {"hits", 2., 0.02},
+  {"volume", 0., 0.02},
+  {"mean diameter", 0., 0.01},
+  {"mean velocity", 0., 0.01}
+};
+
+/**
+ * \var tolerance_uniformity
+ * \brief tolerances of the uniformity statistics of the collector depths.
+ */
+static const Tolerance tolerance_uniformity[UNIFORMITY_COLUMNS] = {
+  {"mean depth", 0., 0.02},
+  {"depth variance", 0., 0.05},
+  {"CU", 1., 0.},
+  {"DU", 2., 0.}
+};
+
+/**
+ * \var tolerance_calibration
+ * \brief tolerance of the calibrated values.
+ */
+static const Tolerance tolerance_calibration = { "calibrated value", 1e-5,
+  1e-3
+};
+
+/**
+ * \var tolerance_profile
+ * \brief tolerances of the radial profile depths.
+ */
+static const Tolerance tolerance_profile[PROFILE_COLUMNS] = {
+  {"radius", 1e-9, 0.},
+  {"depth", 0., 0.02}
+};
+
+/**
+ * \var tolerance_grid
+ * \brief tolerances of the radial pattern depths on the grid points.
+ */
+static const Tolerance tolerance_grid[GRID_COLUMNS] = {
+  {"x", 1e-9, 0.},
+  {"y", 1e-9, 0.},
+  {"depth", 0., 0.02}
+};
+
+/**
+ * \var tolerance_layout
+ * \brief tolerances of the uniformity statistics of every layout spacing.
+ */
+static const Tolerance tolerance_layout[LAYOUT_COLUMNS] = {
+  {"x spacing", 1e-9, 0.},
+  {"y spacing", 1e-9, 0.},
+  {"mean depth", 0., 0.02},
+  {"depth deviation", 0., 0.05},
+  {"CU", 1., 0.},
+  {"DU", 2., 0.}
+};
+
+/**
+ * \var tolerance_sweep
+ * \brief tolerances of the summary of every sweep case.
+ */
+static const Tolerance tolerance_sweep[SWEEP_COLUMNS] = {
+  {"swept value", 1e-9, 0.},
+  {"mean distance", 0., 0.01},
+  {"mean depth", 0., 0.02},
+  {"depth variance", 0., 0.05},
+  {"CU", 1., 0.},
+  {"DU", 2., 0.}
+};
+
+/**
+ * \fn void table_skip_comments (FILE * file)
+ * \brief function to skip the blanks and the comment lines starting with #.
+ * \param file
+ * \brief file.
+ */
+void
+table_skip_comments (FILE * file)
+{
+  int c;
+  for (;;)
+    {
+      if (fscanf (file, " ") == EOF)
+        return;
+      c = getc (file);
+      if (c != '#')
+        {
+          ungetc (c, file);
+          return;
+        }
+      if (fscanf (file, "%*[^\n]") == EOF)
+        return;
+    }
+}
+
+/**
+ * \fn int table_read (Table * t, char *name, unsigned int ncolumns, \
+ *   int labelled)
+ * \brief function to read a table of numbers from a file.
+ * \param t
+ * \brief Table struct.
+ * \param name
+ * \brief file name.
+ * \param ncolumns
+ * \brief number of columns.
+ * \param labelled
+ * \brief 1 if every row starts with a name to skip, 0 otherwise.
+ * \return 1 on success, 0 on error.
+ */
+int
+table_read (Table * t, char *name, unsigned int ncolumns, int labelled)
+{
+  FILE *file;
+  double x[TRAJECTORY_COLUMNS];
+  unsigned int i, n;
+  t->data = NULL;
+  t->nrows = 0;
+  t->ncolumns = ncolumns;
+  file = fopen (name, "r");
+  if (!file)
+    {
+      printf ("compare: unable to open %s\n", name);
+      return 0;
+    }
+  for (n = 0;; ++n)
+    {
+      table_skip_comments (file);
+      if (labelled && fscanf (file, "%*s") == EOF)
+        {
+          i = 0;
+          break;
+        }
+      for (i = 0; i < ncolumns; ++i)
+        if (fscanf (file, "%lf", x + i) != 1)
+          break;
+      if (i < ncolumns)
+        break;
+      t->data = (double *) realloc (t->data, (n + 1) * ncolumns
+                                    * sizeof (double));
+      memcpy (t->data + n * ncolumns, x, ncolumns * sizeof (double));
+    }
+  t->nrows = n;
+  if (i || !feof (file))
+    {
+      printf ("compare: bad row %u in %s\n", n + 1, name);
+      fclose (file);
+      return 0;
+    }
+  fclose (file);
+  return 1;
+}
+
+/**
+ * \fn void comparison_init (Comparison * c, const Tolerance * t)
+ * \brief function to init the comparison of a quantity.
+ * \param c
+ * \brief Comparison struct.
+ * \param t
+ * \brief quantity tolerance.
+ */
+void
+comparison_init (Comparison * c, const Tolerance * t)
+{
+  c->tolerance = t;
+  c->error = c->where = 0.;
+  c->ncompared = c->nfailed = 0;
+}
+
+/**
+ * \fn void comparison_add (Comparison * c, double reference, double value, \
+ *   double where)
+ * \brief function to compare a value with its reference.
+ * \param c
+ * \brief Comparison struct.
+ * \param reference
+ * \brief reference value.
+ * \param value
+ * \brief compared value.
+ * \param where
+ * \brief abscissa of the value.
+ */
+void
+comparison_add (Comparison * c, double reference, double value, double where)
+{
+  double e;
+  e = fabs (value - reference);
+  ++c->ncompared;
+  if (!(e <= c->tolerance->absolute + c->tolerance->relative
+        * fabs (reference)))
+    ++c->nfailed;
+  if (!(e <= c->error))
+    {
+      c->error = e;
+      c->where = where;
+    }
+}
+
+/**
+ * \fn unsigned int comparison_print (Comparison * c, unsigned int n, \
+ *   const char *where)
+ * \brief function to print the summary of the quantities out of tolerance.
+ * \param c
+ * \brief array of Comparison structs.
+ * \param n
+ * \brief number of compared quantities.
+ * \param where
+ * \brief name of the abscissa.
+ * \return number of quantities out of tolerance.
+ */
+unsigned int
+comparison_print (Comparison * c, unsigned int n, const char *where)
+{
+  unsigned int i, nfailed;
+  for (i = nfailed = 0; i < n; ++i)
+    {
+      if (!c[i].nfailed)
+        continue;
+      printf ("  %-20s max error %-12.4lg at %s %-10.4lg tolerance %lg+%lg|x|"
+              " (%u of %u out)\n", c[i].tolerance->name, c[i].error, where,
+              c[i].where, c[i].tolerance->absolute, c[i].tolerance->relative,
+              c[i].nfailed, c[i].ncompared);
+      ++nfailed;
+    }
+  return nfailed;
+}
+
+/**
+ * \fn unsigned int compare_trajectory (Table * r, Table * t)
+ * \brief function to compare a trajectory with its reference. The result is
+ *   linearly interpolated at the times of the reference, so the trajectories
+ *   can be calculated with different time steps.
+ * \param r
+ * \brief reference Table struct.
+ * \param t
+ * \brief result Table struct.
+ * \return number of quantities out of tolerance.
+ */
+unsigned int
+compare_trajectory (Table * r, Table * t)
+{
+  Comparison c[TRAJECTORY_COLUMNS], cl[TRAJECTORY_COLUMNS];
+  double *x, *y, *z;
+  double s, w;
+  unsigned int i, j, k, nfailed;
+  if (!r->nrows || !t->nrows)
+    {
+      printf ("  empty trajectory\n");
+      return r->nrows != t->nrows;
+    }
+  // inverse trajectories go backward in time
+  s = (r->data[(r->nrows - 1) * TRAJECTORY_COLUMNS] < r->data[0]) ? -1. : 1.;
+  for (j = 0; j < TRAJECTORY_COLUMNS; ++j)
+    comparison_init (c + j, tolerance_trajectory + j);
+  for (i = k = 0; i < r->nrows; ++i)
+    {
+      x = r->data + i * TRAJECTORY_COLUMNS;
+      while (k + 1 < t->nrows
+             && s * t->data[(k + 1) * TRAJECTORY_COLUMNS] < s * x[0])
+        ++k;
+      if (k + 1 >= t->nrows)
+        break;
+      y = t->data + k * TRAJECTORY_COLUMNS;
+      z = y + TRAJECTORY_COLUMNS;
+      if (s * y[0] > s * x[0] || z[0] == y[0])
+        continue;
+      w = (x[0] - y[0]) / (z[0] - y[0]);
+      for (j = 1; j < TRAJECTORY_COLUMNS; ++j)
+        comparison_add (c + j, x[j], y[j] + w * (z[j] - y[j]), x[0]);
+    }
+  x = r->data + (r->nrows - 1) * TRAJECTORY_COLUMNS;
+  y = t->data + (t->nrows - 1) * TRAJECTORY_COLUMNS;
+  for (j = 0; j < TRAJECTORY_COLUMNS; ++j)
+    {
+      comparison_init (cl + j, tolerance_landing + j);
+      comparison_add (cl + j, x[j], y[j], x[0]);
+    }
+  nfailed = comparison_print (c, TRAJECTORY_COLUMNS, "t");
+  return nfailed + comparison_print (cl, TRAJECTORY_COLUMNS, "t");
+}
+
+/**
+ * \fn unsigned int compare_landing (Table * r, Table * t)
+ * \brief function to compare the landing points of a drop batch with their
+ *   references.
+ * \param r
+ * \brief reference Table struct.
+ * \param t
+ * \brief result Table struct.
+ * \return number of quantities out of tolerance.
+ */
+unsigned int
+compare_landing (Table * r, Table * t)
+{
+  Comparison c[TRAJECTORY_COLUMNS];
+  unsigned int i, j;
+  if (r->nrows != t->nrows)
+    {
+      printf ("  %u drops, %u in the reference\n", t->nrows, r->nrows);
+      return 1;
+    }
+  for (j = 0; j < TRAJECTORY_COLUMNS; ++j)
+    comparison_init (c + j, tolerance_landing + j);
+  for (i = 0; i < r->nrows; ++i)
+    for (j = 0; j < TRAJECTORY_COLUMNS; ++j)
+      comparison_add (c + j, r->data[i * TRAJECTORY_COLUMNS + j],
+                      t->data[i * TRAJECTORY_COLUMNS + j], i + 1);
+  return comparison_print (c, TRAJECTORY_COLUMNS, "drop");
+}
+
+/**
+ * \fn unsigned int collectors_statistics (Table * t, double **x)
+ * \brief function to calculate the statistics of every collector: position,
+ *   weighted number of hits, volume, mean diameter and mean velocity.
+ * \param t
+ * \brief Table struct of collector measurements.
+ * \param x
+ * \brief pointer to the array of collector statistics.
+ * \return number of collectors.
+ */
+unsigned int
+collectors_statistics (Table * t, double **x)
+{
+  double *y, *z;
+  unsigned int i, j, n;
+  *x = NULL;
+  for (i = n = 0; i < t->nrows; ++i)
+    {
+      y = t->data + i * COLLECTOR_COLUMNS;
+      for (j = 0; j < n; ++j)
+        {
+          z = *x + j * 7;
+          if (z[0] == y[0] && z[1] == y[1] && z[2] == y[2])
+            break;
+        }
+      if (j == n)
+        {
+          *x = (double *) realloc (*x, ++n * 7 * sizeof (double));
+          z = *x + j * 7;
+          memcpy (z, y, 3 * sizeof (double));
+          z[3] = z[4] = z[5] = z[6] = 0.;
+        }
+      z[3] += y[7];
+      z[4] += y[7] * M_PI / 6. * y[3] * y[3] * y[3];
+      z[5] += y[7] * y[3];
+      z[6] += y[7] * sqrt (y[4] * y[4] + y[5] * y[5] + y[6] * y[6]);
+    }
+  for (j = 0; j < n; ++j)
+    {
+      z = *x + j * 7;
+      z[5] /= z[3];
+      z[6] /= z[3];
+    }
+  return n;
+}
+
+/**
+ * \fn unsigned int compare_collectors (Table * r, Table * t)
+ * \brief function to compare the statistics of every collector with their
+ *   references.
+ * \param r
+ * \brief reference Table struct.
+ * \param t
+ * \brief result Table struct.
+ * \return number of quantities out of tolerance.
+ */
+unsigned int
+compare_collectors (Table * r, Table * t)
+{
+  Comparison c[COLLECTOR_QUANTITIES];
+  double zero[7] = { 0., 0., 0., 0., 0., 0., 0. };
+  double *x, *y, *xi, *yj;
+  unsigned int i, j, k, nr, nt, nfailed;
+  nr = collectors_statistics (r, &x);
+  nt = collectors_statistics (t, &y);
+  for (k = 0; k < COLLECTOR_QUANTITIES; ++k)
+    comparison_init (c + k, tolerance_collector + k);
+  nfailed = 0;
+  for (i = 0; i < nr; ++i)
+    {
+      xi = x + i * 7;
+      for (j = 0; j < nt; ++j)
+        {
+          yj = y + j * 7;
+          if (xi[0] == yj[0] && xi[1] == yj[1] && xi[2] == yj[2])
+            break;
+        }
+      if (j == nt)
+        {
+          printf ("  collector (%lg,%lg,%lg) without hits\n",
+                  xi[0], xi[1], xi[2]);
+          yj = zero;
+        }
+      for (k = 0; k < COLLECTOR_QUANTITIES; ++k)
+        comparison_add (c + k, xi[3 + k], yj[3 + k], i + 1);
+    }
+  for (j = 0; j < nt; ++j)
+    {
+      yj = y + j * 7;
+      for (i = 0; i < nr; ++i)
+        {
+          xi = x + i * 7;
+          if (xi[0] == yj[0] && xi[1] == yj[1] && xi[2] == yj[2])
+            break;
+        }
+      if (i == nr)
+        {
+          printf ("  collector (%lg,%lg,%lg) without reference hits\n",
+                  yj[0], yj[1], yj[2]);
+          ++nfailed;
+        }
+    }
+  free (y);
+  free (x);
+  return nfailed + comparison_print (c, COLLECTOR_QUANTITIES, "collector");
+}
+
+/**
+ * \fn unsigned int compare_uniformity (Table * r, Table * t)
+ * \brief function to compare the uniformity statistics of the collector
+ *   depths with their references.
+ * \param r
+ * \brief reference Table struct.
+ * \param t
+ * \brief result Table struct.
+ * \return number of quantities out of tolerance.
+ */
+unsigned int
+compare_uniformity (Table * r, Table * t)
+{
+  Comparison c[UNIFORMITY_COLUMNS];
+  unsigned int i, j;
+  if (r->nrows != t->nrows)
+    {
+      printf ("  %u rows, %u in the reference\n", t->nrows, r->nrows);
+      return 1;
+    }
+  for (j = 0; j < UNIFORMITY_COLUMNS; ++j)
+    comparison_init (c + j, tolerance_uniformity + j);
+  for (i = 0; i < r->nrows; ++i)
+    for (j = 0; j < UNIFORMITY_COLUMNS; ++j)
+      comparison_add (c + j, r->data[i * UNIFORMITY_COLUMNS + j],
+                      t->data[i * UNIFORMITY_COLUMNS + j], i + 1);
+  return comparison_print (c, UNIFORMITY_COLUMNS, "row");
+}
+
+/**
+ * \fn unsigned int compare_calibration (Table * r, Table * t)
+ * \brief function to compare the calibrated variables and the objective
+ *   function value with their references.
+ * \param r
+ * \brief reference Table struct.
+ * \param t
+ * \brief result Table struct.
+ * \return number of quantities out of tolerance.
+ */
+unsigned int
+compare_calibration (Table * r, Table * t)
+{
+  Comparison c[1];
+  unsigned int i;
+  if (r->nrows != t->nrows)
+    {
+      printf ("  %u rows, %u in the reference\n", t->nrows, r->nrows);
+      return 1;
+    }
+  comparison_init (c, &tolerance_calibration);
+  for (i = 0; i < r->nrows; ++i)
+    comparison_add (c, r->data[i], t->data[i], i + 1);
+  return comparison_print (c, 1, "row");
+}
+
+/**
+ * \fn unsigned int compare_rows (Table * r, Table * t, \
+ *   const Tolerance * tolerance)
+ * \brief function to compare a radial profile, a grid, the statistics of a
+ *   layout or the summary of a sweep with its reference, row by row.
+ * \param r
+ * \brief reference Table struct.
+ * \param t
+ * \brief result Table struct.
+ * \param tolerance
+ * \brief array of tolerances of every column.
+ * \return number of quantities out of tolerance.
+ */
+unsigned int
+compare_rows (Table * r, Table * t, const Tolerance * tolerance)
+{
+  Comparison c[TRAJECTORY_COLUMNS];
+  unsigned int i, j, n;
+  if (r->nrows != t->nrows)
+    {
+      printf ("  %u rows, %u in the reference\n", t->nrows, r->nrows);
+      return 1;
+    }
+  n = r->ncolumns;
+  for (j = 0; j < n; ++j)
+    comparison_init (c + j, tolerance + j);
+  for (i = 0; i < r->nrows; ++i)
+    for (j = 0; j < n; ++j)
+      comparison_add (c + j, r->data[i * n + j], t->data[i * n + j], i + 1);
+  return comparison_print (c, n, "row");
+}
+
+/**
+ * \fn int main (int argn, char **argc)
+ * \brief main function.
+ * \param argn
+ * \brief arguments number.
+ * \param argc
+ * \brief argument strings.
+ * \return 0 if the results are within the tolerances, 1 if not, 2 on error.
+ */
+int
+main (int argn, char **argc)
+{
+  Table r[1], t[1];
+  unsigned int nfailed, ncolumns;
+  int labelled;
+  if (argn != 4)
+    {
+      printf ("Usage of this program is:\n"
+              "\tcompare trajectory|landing|collectors|uniformity|calibration"
+              "|profile|grid|layout|sweep reference result\n");
+      return 2;
+    }
+  labelled = 0;
+  if (!strcmp (argc[1], "collectors"))
+    ncolumns = COLLECTOR_COLUMNS;
+  else if (!strcmp (argc[1], "uniformity"))
+    ncolumns = UNIFORMITY_COLUMNS;
+  else if (!strcmp (argc[1], "calibration"))
+    {
+      ncolumns = CALIBRATION_COLUMNS;
+      labelled = 1;
+    }
+  else if (!strcmp (argc[1], "profile"))
+    ncolumns = PROFILE_COLUMNS;
+  else if (!strcmp (argc[1], "grid"))
+    ncolumns = GRID_COLUMNS;
+  else if (!strcmp (argc[1], "layout"))
+    ncolumns = LAYOUT_COLUMNS;
+  else if (!strcmp (argc[1], "sweep"))
+    {
+      ncolumns = SWEEP_COLUMNS;
+      labelled = 1;
+    }
+  else
+    ncolumns = TRAJECTORY_COLUMNS;
+  if (!table_read (r, argc[2], ncolumns, labelled)
+      || !table_read (t, argc[3], ncolumns, labelled))
+    return 2;
+  if (!strcmp (argc[1], "trajectory"))
+    nfailed = compare_trajectory (r, t);
+  else if (!strcmp (argc[1], "landing"))
+    nfailed = compare_landing (r, t);
+  else if (!strcmp (argc[1], "collectors"))
+    nfailed = compare_collectors (r, t);
+  else if (!strcmp (argc[1], "uniformity"))
+    nfailed = compare_uniformity (r, t);
+  else if (!strcmp (argc[1], "calibration"))
+    nfailed = compare_calibration (r, t);
+  else if (!strcmp (argc[1], "profile"))
+    nfailed = compare_rows (r, t, tolerance_profile);
+  else if (!strcmp (argc[1], "grid"))
+    nfailed = compare_rows (r, t, tolerance_grid);
+  else if (!strcmp (argc[1], "layout"))
+    nfailed = compare_rows (r, t, tolerance_layout);
+  else if (!strcmp (argc[1], "sweep"))
+    nfailed = compare_rows (r, t, tolerance_sweep);
+  else
+    {
+      printf ("compare: unknown kind %s\n", argc[1]);
+      return 2;
+    }
+  printf ("%s %s %s\n", nfailed ? "FAIL" : "PASS", argc[1], argc[3]);
+  free (t->data);
+  free (r->data);
+  return nfailed ? 1 : 0;
+}
@@ -47,11 +47,19 @@ OF SUCH DAMAGE.
 #define AIR_HUMIDITY 100.       ///< saturated relative humidity.
 #define AIR_PRESSURE 101325.    ///< atmospheric pressure.
 #define AIR_TEMPERATURE 20.     ///< normal atmospheric temperature in Celsius.
+#define BATCH_DROPS 1024        ///< drops number of a convergence batch.
 #define CFL 0.01                ///< stability CFL number.
+#define CHUNK_DIVISOR 8
+///< divisor of the drops pending on a thread giving the size of its chunks.
+#define CONFIDENCE 0.95         ///< confidence level of the convergence.
 #define DT 0.001                ///< time step size.
 #define MAXIMUM_DROP_DIAMETER 0.0080    ///< maximum diameter of stable drops.
 #define MINIMUM_DROP_DIAMETER 0.0004    ///< minimum diameter of emitted drops.
 #define RANDOM_SEED 7007        ///< pseudo-random numbers generator seed.
+#define SPRINKLER_BLOCKS 1024
+///< maximum number of blocks of drops summed in the drops order.
+#define VOLUME_SAMPLING_UNIFORM 0.9
+///< fraction of the drops sampled uniformly on the volume diameter sampling.
 #define WIND_ANGLE 0.           ///< wind azimuth angle.
 #define WIND_HEIGHT 2.          ///< reference height to measure the wind.
 #define WIND_UNCERTAINTY 0.     ///< wind uncertainty.
@@ -61,7 +69,16 @@ OF SUCH DAMAGE.
 #define DRAG_SPHERE_FUKUI 1     ///< Fukui et al. (1980) model of a sphere drag.
 #define DRAG_SPHERE_MORSI_ALEXANDER 2
   ///< Morsi & Alexander (1972) model of a sphere drag.
+#ifndef INSTRUMENT
+#define INSTRUMENT 0            ///< 1 to compile the instrumentation counters.
+#endif
+#ifndef TRACE
+#define TRACE 1                 ///< 1 to compile the trace-event timeline.
+#endif
+
+#ifndef DRAG_SPHERE
 #define DRAG_SPHERE DRAG_SPHERE_FUKUI   ///< model of a sphere drag.
+#endif
 
 // XML labels
 #define XML_A0                    (const xmlChar*)"a0"
@@ -76,20 +93,50 @@ OF SUCH DAMAGE.
   ///< a4 XML label.
 #define XML_AIR                   (const xmlChar*)"air"
   ///< air XML label.
+#define XML_ALGORITHM             (const xmlChar*)"algorithm"
+  ///< algorithm XML label.
 #define XML_ANGLE                 (const xmlChar*)"angle"
   ///< angle XML label.
+#define XML_ARRANGEMENT           (const xmlChar*)"arrangement"
+  ///< arrangement XML label.
+#define XML_BATCH                 (const xmlChar*)"batch"
+  ///< batch XML label.
+#define XML_BATCH_DROPS           (const xmlChar*)"batch_drops"
+  ///< batch_drops XML label.
 #define XML_BED_LEVEL             (const xmlChar*)"bed_level"
   ///< bed_level XML label.
 #define XML_BIG_DROPS             (const xmlChar*)"big_drops"
   ///< big_drops XML label.
+#define XML_CALIBRATE             (const xmlChar*)"calibrate"
+  ///< calibrate XML label.
+#define XML_CARTESIAN             (const xmlChar*)"cartesian"
+  ///< cartesian XML label.
+#define XML_CENTRAL               (const xmlChar*)"central"
+  ///< central XML label.
 #define XML_CFL                   (const xmlChar*)"cfl"
   ///< cfl XML label.
+#define XML_COLUMNS               (const xmlChar*)"columns"
+  ///< columns XML label.
+#define XML_CONFIDENCE            (const xmlChar*)"confidence"
+  ///< confidence XML label.
 #define XML_CONSTANT              (const xmlChar*)"constant"
   ///< constant XML label.
+#define XML_CONVERGENCE           (const xmlChar*)"convergence"
+  ///< convergence XML label.
+#define XML_DESIGN                (const xmlChar*)"design"
+  ///< design XML label.
 #define XML_DETACH_MODEL          (const xmlChar*)"detach_model"
   ///< detach_model XML label.
 #define XML_DIAMETER              (const xmlChar*)"diameter"
   ///< diameter XML label.
+#define XML_DIAMETER_COLUMN       (const xmlChar*)"diameter_column"
+  ///< diameter_column XML label.
+#define XML_DIAMETER_SAMPLING     (const xmlChar*)"diameter_sampling"
+  ///< diameter_sampling XML label.
+#define XML_DISTANCE_COLUMN       (const xmlChar*)"distance_column"
+  ///< distance_column XML label.
+#define XML_DISTRIBUTION          (const xmlChar*)"distribution"
+  ///< distribution XML label.
 #define XML_DRAG                  (const xmlChar*)"drag"
   ///< drag XML label.
 #define XML_DRAG_MODEL            (const xmlChar*)"drag_model"
@@ -104,8 +151,18 @@ OF SUCH DAMAGE.
   ///< dx XML label.
 #define XML_DY                    (const xmlChar*)"dy"
   ///< dy XML label.
+#define XML_EMPIRICAL             (const xmlChar*)"empirical"
+  ///< empirical XML label.
+#define XML_EXPERIMENT            (const xmlChar*)"experiment"
+  ///< experiment XML label.
 #define XML_FILE                  (const xmlChar*)"file"
   ///< file XML label.
+#define XML_FORWARD               (const xmlChar*)"forward"
+  ///< forward XML label.
+#define XML_GRID                  (const xmlChar*)"grid"
+  ///< grid XML label.
+#define XML_GRID_STEP             (const xmlChar*)"grid_step"
+  ///< grid_step XML label.
 #define XML_HEIGHT                (const xmlChar*)"height"
   ///< height XML label.
 #define XML_HORIZONTAL_ANGLE      (const xmlChar*)"horizontal_angle"
@@ -120,42 +177,104 @@ OF SUCH DAMAGE.
   ///< jet_model XML label.
 #define XML_JET_TIME              (const xmlChar*)"jet_time"
   ///< jet_time XML label.
+#define XML_LAYOUT                (const xmlChar*)"layout"
+  ///< layout XML label.
+#define XML_LIST                  (const xmlChar*)"list"
+  ///< list XML label.
+#define XML_MAXIMUM               (const xmlChar*)"maximum"
+  ///< maximum XML label.
 #define XML_MEASUREMENT           (const xmlChar*)"measurement"
   ///< measurement XML label.
 #define XML_MAXIMUM_ANGLE         (const xmlChar*)"maximum_angle"
   ///< maximum angle XML label.
 #define XML_MAXIMUM_DROP_DIAMETER (const xmlChar*)"maximum_drop_diameter"
   ///< maximum drop_diameter XML label.
+#define XML_MINIMUM               (const xmlChar*)"minimum"
+  ///< minimum XML label.
 #define XML_MINIMUM_ANGLE         (const xmlChar*)"minimum_angle"
   ///< minimum angle XML label.
 #define XML_MINIMUM_DROP_DIAMETER (const xmlChar*)"minimum_drop_diameter"
   ///< minimum drop_diameter XML label.
+#define XML_MONTE_CARLO           (const xmlChar*)"Monte-Carlo"
+  ///< Monte-Carlo XML label.
+#define XML_NAME                  (const xmlChar*)"name"
+  ///< name XML label.
+#define XML_NCANDIDATES           (const xmlChar*)"ncandidates"
+  ///< ncandidates XML label.
+#define XML_NINITIAL              (const xmlChar*)"ninitial"
+  ///< ninitial XML label.
+#define XML_NODE                  (const xmlChar*)"node"
+  ///< node XML label.
+#define XML_NSIMULATIONS          (const xmlChar*)"nsimulations"
+  ///< nsimulations XML label.
 #define XML_NULL_DRAG             (const xmlChar*)"null_drag"
   ///< null_drag XML label.
 #define XML_OVOID                 (const xmlChar*)"ovoid"
   ///< ovoid XML label.
+#define XML_PRECISION             (const xmlChar*)"precision"
+  ///< precision XML label.
 #define XML_PRESSURE              (const xmlChar*)"pressure"
   ///< pressure XML label.
 #define XML_PROGRESSIVE           (const xmlChar*)"progressive"
   ///< progressive XML label.
+#define XML_RADIUS                (const xmlChar*)"radius"
+  ///< radius XML label.
 #define XML_RANDOM                (const xmlChar*)"random"
   ///< random XML label.
+#define XML_RELATIVE_ERROR        (const xmlChar*)"relative_error"
+  ///< relative_error XML label.
+#define XML_RINGS                 (const xmlChar*)"rings"
+  ///< rings XML label.
+#define XML_SAMPLING              (const xmlChar*)"sampling"
+  ///< sampling XML label.
+#define XML_SCHEME                (const xmlChar*)"scheme"
+  ///< scheme XML label.
+#define XML_SENSITIVITY           (const xmlChar*)"sensitivity"
+  ///< sensitivity XML label.
+#define XML_SOBOL                 (const xmlChar*)"sobol"
+  ///< sobol XML label.
+#define XML_SPACING               (const xmlChar*)"spacing"
+  ///< spacing XML label.
 #define XML_SPHERE                (const xmlChar*)"sphere"
   ///< sphere XML label.
 #define XML_SPRINKLER             (const xmlChar*)"sprinkler"
   ///< sprinkler XML label.
+#define XML_SQUARE                (const xmlChar*)"square"
+  ///< square XML label.
+#define XML_STATE                 (const xmlChar*)"state"
+  ///< state XML label.
+#define XML_STEP                  (const xmlChar*)"step"
+  ///< step XML label.
+#define XML_STRATIFIED            (const xmlChar*)"stratified"
+  ///< stratified XML label.
+#define XML_SURROGATE             (const xmlChar*)"surrogate"
+  ///< surrogate XML label.
+#define XML_SWEEP                 (const xmlChar*)"sweep"
+  ///< sweep XML label.
 #define XML_TEMPERATURE           (const xmlChar*)"temperature"
   ///< temperature XML label.
+#define XML_TEMPLATE1             (const xmlChar*)"template1"
+  ///< template1 XML label.
 #define XML_TOTAL                 (const xmlChar*)"total"
   ///< total XML label.
 #define XML_TRAJECTORY            (const xmlChar*)"trajectory"
   ///< trajectory XML label.
+#define XML_TRIANGULAR            (const xmlChar*)"triangular"
+  ///< triangular XML label.
 #define XML_UNCERTAINTY           (const xmlChar*)"uncertainty"
   ///< uncertainty XML label.
+#define XML_UNIFORM               (const xmlChar*)"uniform"
+  ///< uniform XML label.
+#define XML_VALUES                (const xmlChar*)"values"
+  ///< values XML label.
+#define XML_VARIABLE              (const xmlChar*)"variable"
+  ///< variable XML label.
 #define XML_VELOCITY              (const xmlChar*)"velocity"
   ///< velocity XML label.
 #define XML_VERTICAL_ANGLE        (const xmlChar*)"vertical_angle"
   ///< horizontal angle XML label.
+#define XML_VOLUME                (const xmlChar*)"volume"
+  ///< volume XML label.
 #define XML_X                     (const xmlChar*)"x"
   ///< x XML label.
 #define XML_Y                     (const xmlChar*)"y"
@@ -46,27 +46,20 @@ OF SUCH DAMAGE.
 #endif
 #include "config.h"
 #include "utils.h"
+#include "instrument.h"
 #include "air.h"
 #include "drop.h"
 
 #define DEBUG_DROP 0            ///< macro to debug drop functions.
 
-double drop_diameter;           ///< drop diameter.
-unsigned int drop_detach_model; ///< drop jet detach model.
-unsigned int drop_drag_model;   ///< drop drag resistance model.
-double drop_velocity;           ///< drop initial velocity.
-double drop_horizontal_angle;
-  ///< horizontal angle of the drop initial velocity.
-double drop_vertical_angle;
-  ///< vertical angle of the drop initial velocity.
-double drop_drag_coefficient;
-  ///< drop drag resistance coefficient for the constant model.
-double drop_maximum_diameter;   ///< maximum diameter of stable drops.
-double (*drop_axis_ratio) (Drop * d, Air * a, double v);
+double (*drop_axis_ratio) (Drop * d, Air * a, double v)
+  = drop_axis_ratio_Burguete;
   ///< pointer to the function to calculate the drop axis ratio.
-double (*drop_drag) (Drop * d, Air * a, double v);
-  ///< pointer to the function to calculate the drop drag resistance
-  ///< coefficient.
+double (*drop_drag[3]) (Drop * d, Air * a, double v) = {
+  drop_drag_constant, drop_drag_sphere, drop_drag_ovoid
+};
+  ///< array of pointers to the functions to calculate the drop drag
+  ///< resistance coefficient ordered by drag resistance model.
 
 /**
  * \fn double water_compressibility (double t)
@@ -176,27 +169,13 @@ drop_init (Drop * d, Air * a, gsl_rng * rng)
 #if DEBUG_DROP
   fprintf (stderr, "drop_init: start\n");
 #endif
-  d->diameter = drop_diameter;
   d->density = water_density (a);
   d->surface_tension = water_surface_tension (a->kelvin);
-  if (drop_detach_model == DROP_DETACH_MODEL_RANDOM)
+  d->axis_ratio = 1.;
+  if (d->detach_model == DROP_DETACH_MODEL_RANDOM)
     d->jet_time *= gsl_rng_uniform (rng);
-  switch (drop_drag_model)
-    {
-    case DROP_DRAG_MODEL_CONSTANT:
-      drop_drag = drop_drag_constant;
-	  d->axis_ratio = 1.;
-      break;
-    case DROP_DRAG_MODEL_SPHERE:
-      drop_drag = drop_drag_sphere;
-	  d->axis_ratio = 1.;
-      break;
-    default:
-      drop_axis_ratio = drop_axis_ratio_Burguete;
-      drop_drag = drop_drag_ovoid;
-    }
 #if DEBUG_DROP
-  fprintf (stderr, "drop_init: drag_model=%u\n", drop_drag_model);
+  fprintf (stderr, "drop_init: drag_model=%u\n", d->drag_model);
   fprintf (stderr, "drop_init: density=%lg\n", d->density);
   fprintf (stderr, "drop_init: surface tension=%lg\n", d->surface_tension);
   fprintf (stderr, "drop_init: end\n");
@@ -230,9 +209,10 @@ drop_open_console (Drop * d, Air * a)
   fprintf (stderr, "drop_open_console: start\n");
 #endif
   printf ("Drop diameter: ");
-  scanf ("%lf", &drop_diameter);
+  scanf ("%lf", &d->diameter);
+  d->weight = 1.;
   printf ("Drop jet model (0: total, 1: random): ");
-  scanf ("%u", &drop_detach_model);
+  scanf ("%u", &d->detach_model);
 #if DEBUG_DROP
   fprintf (stderr, "drop_open_console: end\n");
 #endif
@@ -253,7 +233,7 @@ int
 drop_open_xml (Drop * d, Air * a, xmlNode * node)
 {
   xmlChar *buffer;
-  double sh, ch, sv, cv;
+  double velocity, horizontal_angle, vertical_angle, sh, ch, sv, cv;
   int k;
 #if DEBUG_DROP
   fprintf (stderr, "drop_open_xml: start\n");
@@ -264,12 +244,13 @@ drop_open_xml (Drop * d, Air * a, xmlNode * node)
       drop_error (gettext ("bad label"));
       goto exit_on_error;
     }
-  drop_diameter = xml_node_get_float (node, XML_DIAMETER, &k);
+  d->diameter = xml_node_get_float (node, XML_DIAMETER, &k);
   if (!k)
     {
       drop_error (gettext ("bad diameter"));
       goto exit_on_error;
     }
+  d->weight = 1.;
   d->r[0] = xml_node_get_float_with_default (node, XML_X, 0., &k);
   if (!k)
     {
@@ -288,20 +269,20 @@ drop_open_xml (Drop * d, Air * a, xmlNode * node)
       drop_error (gettext ("bad z"));
       goto exit_on_error;
     }
-  drop_velocity = xml_node_get_float_with_default (node, XML_VELOCITY, 0., &k);
+  velocity = xml_node_get_float_with_default (node, XML_VELOCITY, 0., &k);
   if (!k)
     {
       drop_error (gettext ("bad velocity"));
       goto exit_on_error;
     }
-  drop_horizontal_angle
+  horizontal_angle
     = xml_node_get_float_with_default (node, XML_HORIZONTAL_ANGLE, 0., &k);
   if (!k)
     {
       drop_error (gettext ("bad horizontal angle"));
       goto exit_on_error;
     }
-  drop_vertical_angle
+  vertical_angle
     = xml_node_get_float_with_default (node, XML_VERTICAL_ANGLE, 0., &k);
   if (!k)
     {
@@ -316,40 +297,44 @@ drop_open_xml (Drop * d, Air * a, xmlNode * node)
     }
   if (!xmlStrcmp (buffer, XML_CONSTANT))
     {
-      drop_drag_model = DROP_DRAG_MODEL_CONSTANT;
-      drop_drag_coefficient
+      d->drag_model = DROP_DRAG_MODEL_CONSTANT;
+      d->drag_coefficient
         = xml_node_get_float_with_default (node, XML_DRAG, 0., &k);
       if (!k)
         {
           drop_error (gettext ("bad drag value"));
+          xmlFree (buffer);
           goto exit_on_error;
         }
     }
   else if (!xmlStrcmp (buffer, XML_SPHERE))
-    drop_drag_model = DROP_DRAG_MODEL_SPHERE;
+    d->drag_model = DROP_DRAG_MODEL_SPHERE;
   else if (!xmlStrcmp (buffer, XML_OVOID))
-    drop_drag_model = DROP_DRAG_MODEL_OVOID;
+    d->drag_model = DROP_DRAG_MODEL_OVOID;
   else
     {
       drop_error (gettext ("unknown drag resistance model"));
+      xmlFree (buffer);
       goto exit_on_error;
     }
   xmlFree (buffer);
   buffer = xmlGetProp (node, XML_DETACH_MODEL);
   if (!buffer || !xmlStrcmp (buffer, XML_TOTAL))
-    drop_detach_model = DROP_DETACH_MODEL_TOTAL;
+    d->detach_model = DROP_DETACH_MODEL_TOTAL;
   else if (!xmlStrcmp (buffer, XML_RANDOM))
-    drop_detach_model = DROP_DETACH_MODEL_RANDOM;
+    d->detach_model = DROP_DETACH_MODEL_RANDOM;
   else
     {
       drop_error (gettext ("unknown jet detach model"));
+      xmlFree (buffer);
       goto exit_on_error;
     }
-  sincos (M_PI / 180. * drop_horizontal_angle, &sh, &ch);
-  sincos (M_PI / 180. * drop_vertical_angle, &sv, &cv);
-  d->v[0] = drop_velocity * cv * ch;
-  d->v[1] = drop_velocity * cv * sh;
-  d->v[2] = drop_velocity * sv;
+  xmlFree (buffer);
+  sincos (M_PI / 180. * horizontal_angle, &sh, &ch);
+  sincos (M_PI / 180. * vertical_angle, &sv, &cv);
+  d->v[0] = velocity * cv * ch;
+  d->v[1] = velocity * cv * sh;
+  d->v[2] = velocity * sv;
 #if DEBUG_DROP
   fprintf (stderr, "drop_open_xml: end\n");
 #endif
@@ -410,7 +395,7 @@ drop_axis_ratio_Burguete (Drop * d, Air * a, double v)
 double
 drop_drag_constant (Drop * d, Air * a, double v)
 {
-  return drop_drag_coefficient;
+  return d->drag_coefficient;
 }
 
 /**
@@ -505,16 +490,20 @@ drop_move (Drop * d, Air * a, double factor)
   double vrx, vry, v;
 #if DEBUG_DROP
   fprintf (stderr, "drop_move: start\n");
+#endif
+#if INSTRUMENT
+  instrument_count (INSTRUMENT_DROP_MOVE);
 #endif
   vrx = d->v[0] - a->u;
   vry = d->v[1] - a->v;
   v = vector_module (vrx, vry, d->v[2]);
 #if DEBUG_DROP
   fprintf (stderr, "drop_move: vr=(%lg,%lg,%lg) v=%lg\n", vrx, vry, d->v[2], v);
-  fprintf (stderr, "drop_move: cd=%lg\n", drop_drag (d, a, v));
+  fprintf (stderr, "drop_move: cd=%lg\n",
+           drop_drag[d->drag_model] (d, a, v));
 #endif
-  d->drag = -0.75 * factor * v * drop_drag (d, a, v) * a->density
-    / (d->density * d->diameter);
+  d->drag = -0.75 * factor * v * drop_drag[d->drag_model] (d, a, v)
+    * a->density / (d->density * d->diameter);
   d->a[0] = d->drag * vrx;
   d->a[1] = d->drag * vry;
   d->a[2] = -(1. - a->density / d->density) * G + d->drag * d->v[2];
@@ -544,7 +533,7 @@ dialog_drop_new (Drop * d, Air * a)
   dlg->label_diameter = (GtkLabel *) gtk_label_new ("Diámetro de la gota");
   dlg->spin_diameter = (GtkSpinButton *)
     gtk_spin_button_new_with_range (0.00050, 0.00700, 0.00001);
-  gtk_spin_button_set_value (dlg->spin_diameter, drop_diameter);
+  gtk_spin_button_set_value (dlg->spin_diameter, d->diameter);
 
   dlg->grid = (GtkGrid *) gtk_grid_new ();
   gtk_grid_attach (dlg->grid, (GtkWidget *) dlg->label_diameter, 0, 0, 1, 1);
@@ -562,7 +551,7 @@ dialog_drop_new (Drop * d, Air * a)
 
   if (gtk_dialog_run (dlg->window) == GTK_RESPONSE_OK)
     {
-      drop_diameter = gtk_spin_button_get_value (dlg->spin_diameter);
+      d->diameter = gtk_spin_button_get_value (dlg->spin_diameter);
       drop_init (d, a);
     }
   gtk_widget_destroy ((GtkWidget *) dlg->window);
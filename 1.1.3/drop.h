@@ -74,19 +74,16 @@ typedef struct
   double surface_tension;       ///< surface tension.
   double axis_ratio;            ///< axis ratio.
   double drag;                  ///< drag resistance factor.
+  double drag_coefficient;
+  ///< drag resistance coefficient for the constant model.
   double jet_time;              ///< time into the jet.
+  double weight;                ///< statistical weight.
+  unsigned int detach_model;    ///< jet detach model.
+  unsigned int drag_model;      ///< drag resistance model.
 } Drop;
 
-extern double drop_diameter;
-extern unsigned int drop_detach_model;
-extern unsigned int drop_drag_model;
-extern double drop_velocity;
-extern double drop_horizontal_angle;
-extern double drop_vertical_angle;
-extern double drop_maximum_diameter;
-extern double drop_drag_coefficient;
-extern double (*drag_axis_ratio) (Drop * d, Air * a, double v);
-extern double (*drop_drag) (Drop * d, Air * a, double v);
+extern double (*drop_axis_ratio) (Drop * d, Air * a, double v);
+extern double (*drop_drag[3]) (Drop * d, Air * a, double v);
 
 double water_compressibility (double t);
 double water_density (Air * a);
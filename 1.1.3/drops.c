@@ -5,24 +5,30 @@
  * \author Javier Burguete Tolosa.
  * \copyright Copyright 2012-2015 Javier Burguete Tolosa, all rights reserved.
  */
+#define _GNU_SOURCE
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <math.h>
+#include <libxml/parser.h>
+#include <glib.h>
+#include <gsl/gsl_rng.h>
+#include "config.h"
+#include "utils.h"
+#include "air.h"
+#include "drop.h"
+#include "measurement.h"
+#include "trajectory.h"
+#include "sprinkler.h"
 
 /**
  * \def DROP_MAX
  * \brief Macro to define the maximum drop diameter size.
  * \def DROP_MIN
  * \brief Macro to define the minimum drop diameter size.
- * \def RANDOM_SEED
- * \brief Macro to define the default pseudo-random numbers generator seed.
- * \def DT
- * \brief Macro to define the default time step size of the numerical method.
  */
 #define DROP_MAX 0.007
 #define DROP_MIN 0.0005
-#define RANDOM_SEED 7
-#define DT 0.001
 
 /**
  * \struct Data
@@ -88,48 +94,164 @@ data_read (Data * data, char *file_name)
   return 1;
 }
 
+/**
+ * \struct DropsThread
+ * \brief Struct to define the data of a thread calculating drops.
+ */
+typedef struct
+{
+  Data *data;                   ///< drops set data.
+  Air air[1];                   ///< Air struct copy.
+  Trajectory trajectory[1];     ///< Trajectory struct.
+  double *output;               ///< array of drop results.
+  unsigned int first;           ///< first drop.
+  unsigned int last;            ///< last drop.
+} DropsThread;
+
+/**
+ * \fn void drops_drop (Data * data, Air * a, Trajectory * t, gsl_rng * rng, \
+ *   unsigned int i, double *y)
+ * \brief Function to calculate the i-th drop with its own pseudo-random numbers
+ *   substream.
+ * \param data
+ * \brief Drops set data.
+ * \param a
+ * \brief Air struct.
+ * \param t
+ * \brief Trajectory struct.
+ * \param rng
+ * \brief GSL pseudo-random numbers generator struct.
+ * \param i
+ * \brief Drop number.
+ * \param y
+ * \brief Drop results: jet length, drop diameter, range, final horizontal and
+ *   vertical velocities.
+ */
+void
+drops_drop (Data * data, Air * a, Trajectory * t, gsl_rng * rng,
+            unsigned int i, double *y)
+{
+  Sprinkler s[1];
+  Drop *d;
+  double drop_diameter, jet_length;
+  gsl_rng_set (rng, random_seed (RANDOM_SEED, i));
+  drop_diameter = DROP_MIN + (DROP_MAX - DROP_MIN) * gsl_rng_uniform (rng);
+  jet_length = data->jet_length * gsl_rng_uniform (rng);
+  s->x = s->y = s->horizontal_angle = s->bed_level = 0.;
+  s->z = data->sprinkler_height;
+  s->pressure = data->sprinkler_pressure;
+  s->vertical_angle = data->sprinkler_angle;
+  s->drop_dmax = DROP_MAX;
+  s->dt = DT;
+  s->cfl = CFL;
+  trajectory_open_data (t, a, rng, drop_diameter,
+                        TRAJECTORY_JET_MODEL_NULL_DRAG,
+                        DROP_DETACH_MODEL_TOTAL, DROP_DRAG_MODEL_OVOID,
+                        DROP_MAX, 0.);
+  d = t->drop;
+  t->jet_time = 0.;
+  trajectory_init (t, a, rng);
+
+  // the null drag jet moves at the nozzle velocity
+  t->jet_time = d->jet_time
+    = jet_length / sqrt (2. * s->pressure / d->density);
+  trajectory_init_with_sprinkler (t, s);
+  air_wind_uncertainty (a, rng);
+  trajectory_calculate (t, a, NULL, 0, NULL);
+  y[0] = jet_length;
+  y[1] = drop_diameter;
+  y[2] = d->r[0];
+  y[3] = d->v[0];
+  y[4] = d->v[2];
+}
+
+/**
+ * \fn static gpointer drops_thread (DropsThread * thread)
+ * \brief Function to calculate the drops of a thread.
+ * \param thread
+ * \brief DropsThread struct.
+ * \return NULL.
+ */
+static gpointer
+drops_thread (DropsThread * thread)
+{
+  gsl_rng *rng;
+  unsigned int i;
+  rng = gsl_rng_alloc (gsl_rng_taus);
+  for (i = thread->first; i < thread->last; ++i)
+    drops_drop (thread->data, thread->air, thread->trajectory, rng, i,
+                thread->output + 5 * i);
+  gsl_rng_free (rng);
+  return NULL;
+}
+
+/**
+ * \fn int main (int argn, char **argc)
+ * \brief Main function.
+ * \param argn
+ * \brief Arguments number.
+ * \param argc
+ * \brief Argument strings.
+ * \return Error code.
+ */
 int
 main (int argn, char **argc)
 {
-  int i;
-  double drop_diameter, jet_length, x[8], y[8];
-  FILE *file, *file_output;
+  Air air[1];
   Data data[1];
-  srand (RANDOM_SEED);
+  DropsThread *thread;
+  GThread **thread_id;
+  FILE *file_output;
+  double *output;
+  unsigned int i, n;
+  n = g_get_num_processors ();
+  if (argn == 5 && !strcmp (argc[1], "-nthreads"))
+    {
+      n = atoi (argc[2]);
+      argn -= 2;
+      argc += 2;
+    }
+  if (argn != 3)
+    {
+      printf ("Usage of this program is:\n"
+              "\tdrops [-nthreads N] data_file results_file\n");
+      return 1;
+    }
   if (!data_read (data, argc[1]))
     return 1;
   file_output = fopen (argc[2], "w");
-  for (i = 0; i < data->drops_number; ++i)
+  if (!file_output)
+    return 2;
+  air_temperature = data->air_temperature;
+  air_humidity = data->air_humidity;
+  air_pressure = data->air_pressure;
+  air_velocity = data->wind_velocity;
+  air_angle = data->wind_angle;
+  air_uncertainty = 0.;
+  air_init (air);
+  output = (double *) g_malloc (5 * data->drops_number * sizeof (double));
+  n = MAX (1, MIN (n, data->drops_number));
+  thread = (DropsThread *) g_malloc (n * sizeof (DropsThread));
+  thread_id = (GThread **) g_malloc (n * sizeof (GThread *));
+  for (i = 0; i < n; ++i)
     {
-      file = fopen ("input", "w");
-      drop_diameter = DROP_MIN + (DROP_MAX - DROP_MIN) * rand ()
-        / ((double) RAND_MAX);
-      jet_length = data->jet_length * rand () / ((double) RAND_MAX);
-      fprintf (file, "0 0 %le %le %le 0 %le 0 %le %le %le %le %le %le %le",
-               data->sprinkler_height,
-               data->sprinkler_pressure,
-               data->sprinkler_angle,
-               jet_length,
-               data->wind_velocity,
-               data->wind_angle,
-               data->air_temperature,
-               data->air_humidity, data->air_pressure, drop_diameter, DT);
-      fclose (file);
-      system ("./trajectory input output");
-      file = fopen ("output", "r");
-      while (fscanf (file, "%le%le%le%le%le%le%le%le",
-                     x, x + 1, x + 2, x + 3, x + 4, x + 5, x + 6, x + 7) == 8)
-        memcpy (y, x, 8 * sizeof (double));
-      fclose (file);
-      fprintf (file_output, "%le %le %le %le %le\n",
-               jet_length, drop_diameter, y[1], y[4], y[6]);
-
+      thread[i].data = data;
+      memcpy (thread[i].air, air, sizeof (Air));
+      thread[i].output = output;
+      thread[i].first = i * data->drops_number / n;
+      thread[i].last = (i + 1) * data->drops_number / n;
+      thread_id[i]
+        = g_thread_new (NULL, (GThreadFunc) drops_thread, thread + i);
     }
+  for (i = 0; i < n; ++i)
+    g_thread_join (thread_id[i]);
+  for (i = 0; i < data->drops_number; ++i)
+    fprintf (file_output, "%le %le %le %le %le\n", output[5 * i],
+             output[5 * i + 1], output[5 * i + 2], output[5 * i + 3],
+             output[5 * i + 4]);
   fclose (file_output);
-#ifdef WIN32
-  system ("del input output");
-#else
-  system ("rm input output");
-#endif
+  g_free (thread_id);
+  g_free (thread);
+  g_free (output);
   return 0;
 }
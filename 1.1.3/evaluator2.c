@@ -1,18 +1,35 @@
+/**
+ * \file evaluator2.c
+ * \brief File to evaluate the squared error between the range of a simulated
+ *   drop trajectory and the measured one.
+ * \author Javier Burguete Tolosa.
+ * \copyright Copyright 2012-2015 Javier Burguete Tolosa, all rights reserved.
+ */
 #include <stdio.h>
+#include "objective.h"
+
+#define RANGE 13.49             ///< measured range.
 
 int
 main (int argn, char **argc)
 {
   char buffer[512];
+  Objective o[1];
   FILE *file;
-  double t[9], e;
+  double t[9];
+  if (argn != 4)
+    return 1;
+  objective_open_range (o, RANGE);
   snprintf (buffer, 512, "%s-vyr", argc[1]);
   file = fopen (buffer, "r");
+  if (!file)
+    return 2;
   while (fscanf (file, "%lf%lf%lf%lf%lf%lf%lf%lf%lf", t, t + 1, t + 2, t + 3,
-                 t + 4, t + 5, t + 6, t + 7, t + 8) == 9);
+                 t + 4, t + 5, t + 6, t + 7, t + 8) == 9)
+    objective_add (o, t[1], t[3]);
   fclose (file);
   file = fopen (argc[3], "w");
-  e = t[1] - 13.49;
-  fprintf (file, "%.14le", e * e);
+  fprintf (file, "%.14le", objective_error (o));
   fclose (file);
+  return 0;
 }
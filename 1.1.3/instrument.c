@@ -0,0 +1,245 @@
+/*
+Sprinkler: a software to calculate drop trajectories in sprinkler irrigation.
+
+AUTHORS: Javier Burguete.
+
+Copyright 2012-2015, AUTHORS.
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+	1. Redistributions of source code must retain the above copyright notice,
+		this list of conditions and the following disclaimer.
+
+	2. Redistributions in binary form must reproduce the above copyright notice,
+		this list of conditions and the following disclaimer in the
+		documentation and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY AUTHORS ``AS IS'' AND ANY EXPRESS OR IMPLIED
+WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+SHALL AUTHORS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+
+/**
+ * \file instrument.c
+ * \brief Source file to count the calls of the hot path functions and to time
+ *   the phases of the drop trajectories. Every thread accumulates its own data
+ *   and the data of all threads are added and written in JSON format at exit,
+ *   in the file named by the SPRINKLER_INSTRUMENT environment variable or in
+ *   INSTRUMENT_FILE.
+ * \author Javier Burguete Tolosa.
+ * \copyright Copyright 2012-2015 Javier Burguete Tolosa, all rights reserved.
+ */
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <glib.h>
+#include "config.h"
+#include "instrument.h"
+
+#if INSTRUMENT
+
+#define INSTRUMENT_FILE "instrument.json"
+///< default name of the instrumentation file.
+
+static __thread Instrument *instrument = NULL;
+///< instrumentation data of the thread.
+static Instrument **instrument_list = NULL;
+///< array of the instrumentation data of all threads.
+static unsigned int instrument_nthreads = 0;
+///< number of instrumented threads.
+static GMutex instrument_mutex;
+///< mutex to access the array of instrumentation data.
+
+static const char *instrument_counter_name[INSTRUMENT_COUNTERS] = {
+  "trajectories", "runge_kutta_4_steps", "drop_move_calls",
+  "cfl_limited_steps", "dt_limited_steps", "measurement_tests",
+  "measurement_hits"
+};                              ///< labels of the counters.
+
+static const char *instrument_phase_name[INSTRUMENT_PHASES] = {
+  "jet_time", "flight_time", "impact_time", "output_time"
+};                              ///< labels of the phase times.
+
+/**
+ * \fn Instrument *instrument_get ()
+ * \brief function to get the instrumentation data of the thread, creating them
+ *   on the first call.
+ * \return Instrument struct.
+ */
+Instrument *
+instrument_get ()
+{
+  if (instrument)
+    return instrument;
+  instrument = (Instrument *) g_malloc0 (sizeof (Instrument));
+  g_mutex_lock (&instrument_mutex);
+  if (!instrument_nthreads)
+    atexit (instrument_write);
+  instrument_list = (Instrument **)
+    g_realloc (instrument_list, (instrument_nthreads + 1)
+               * sizeof (Instrument *));
+  instrument_list[instrument_nthreads++] = instrument;
+  g_mutex_unlock (&instrument_mutex);
+  return instrument;
+}
+
+/**
+ * \fn unsigned long long int instrument_time ()
+ * \brief function to get a monotonic time.
+ * \return time in nanoseconds.
+ */
+unsigned long long int
+instrument_time ()
+{
+  struct timespec t;
+  clock_gettime (CLOCK_MONOTONIC, &t);
+  return 1000000000ull * t.tv_sec + t.tv_nsec;
+}
+
+/**
+ * \fn void instrument_trajectory (double diameter)
+ * \brief function to start the instrumentation of a trajectory, selecting the
+ *   drop diameter class of the next counters and times.
+ * \param diameter
+ * \brief drop diameter.
+ */
+void
+instrument_trajectory (double diameter)
+{
+  Instrument *i;
+  i = instrument_get ();
+  // the diameter is checked before converting it, the negative, NaN and too
+  // big values go to the last class
+  if (diameter >= 0. && diameter < INSTRUMENT_CLASS_WIDTH * INSTRUMENT_CLASSES)
+    i->class = MIN (diameter / INSTRUMENT_CLASS_WIDTH, INSTRUMENT_CLASSES - 1);
+  else
+    i->class = INSTRUMENT_CLASSES - 1;
+  ++i->counter[i->class][INSTRUMENT_TRAJECTORIES];
+}
+
+/**
+ * \fn void instrument_count (unsigned int counter)
+ * \brief function to increment a counter.
+ * \param counter
+ * \brief counter type (see ::InstrumentCounter).
+ */
+void
+instrument_count (unsigned int counter)
+{
+  Instrument *i;
+  i = instrument_get ();
+  ++i->counter[i->class][counter];
+}
+
+/**
+ * \fn void instrument_phase (unsigned int phase, unsigned long long int time)
+ * \brief function to add the time of a phase.
+ * \param phase
+ * \brief phase type (see ::InstrumentPhase).
+ * \param time
+ * \brief phase time in nanoseconds.
+ */
+void
+instrument_phase (unsigned int phase, unsigned long long int time)
+{
+  Instrument *i;
+  i = instrument_get ();
+  i->time[i->class][phase] += time;
+}
+
+/**
+ * \fn static void instrument_write_class (FILE * file, \
+ *   unsigned long long int *counter, unsigned long long int *time)
+ * \brief function to write the counters and the phase times of a class.
+ * \param file
+ * \brief JSON file.
+ * \param counter
+ * \brief array of counters.
+ * \param time
+ * \brief array of phase times.
+ */
+static void
+instrument_write_class (FILE * file, unsigned long long int *counter,
+                        unsigned long long int *time)
+{
+  unsigned int i;
+  for (i = 0; i < INSTRUMENT_COUNTERS; ++i)
+    fprintf (file, ", \"%s\": %llu", instrument_counter_name[i], counter[i]);
+  for (i = 0; i < INSTRUMENT_PHASES; ++i)
+    fprintf (file, ", \"%s\": %.9lf", instrument_phase_name[i],
+             1e-9 * time[i]);
+}
+
+/**
+ * \fn void instrument_write ()
+ * \brief function to add the instrumentation data of all threads and to write
+ *   them in JSON format, as totals and by drop diameter class.
+ */
+void
+instrument_write ()
+{
+  unsigned long long int counter[INSTRUMENT_CLASSES][INSTRUMENT_COUNTERS],
+    time[INSTRUMENT_CLASSES][INSTRUMENT_PHASES],
+    total_counter[INSTRUMENT_COUNTERS], total_time[INSTRUMENT_PHASES];
+  const char *name;
+  FILE *file;
+  unsigned int i, j, k;
+  memset (counter, 0, sizeof (counter));
+  memset (time, 0, sizeof (time));
+  memset (total_counter, 0, sizeof (total_counter));
+  memset (total_time, 0, sizeof (total_time));
+  g_mutex_lock (&instrument_mutex);
+  for (k = 0; k < instrument_nthreads; ++k)
+    for (i = 0; i < INSTRUMENT_CLASSES; ++i)
+      {
+        for (j = 0; j < INSTRUMENT_COUNTERS; ++j)
+          counter[i][j] += instrument_list[k]->counter[i][j];
+        for (j = 0; j < INSTRUMENT_PHASES; ++j)
+          time[i][j] += instrument_list[k]->time[i][j];
+      }
+  g_mutex_unlock (&instrument_mutex);
+  for (i = 0; i < INSTRUMENT_CLASSES; ++i)
+    {
+      for (j = 0; j < INSTRUMENT_COUNTERS; ++j)
+        total_counter[j] += counter[i][j];
+      for (j = 0; j < INSTRUMENT_PHASES; ++j)
+        total_time[j] += time[i][j];
+    }
+  name = getenv ("SPRINKLER_INSTRUMENT");
+  if (!name)
+    name = INSTRUMENT_FILE;
+  file = fopen (name, "w");
+  if (!file)
+    return;
+  fprintf (file, "{\n  \"threads\": %u,\n  \"total\": {\"diameter_min\": 0",
+           instrument_nthreads);
+  instrument_write_class (file, total_counter, total_time);
+  fprintf (file, "},\n  \"classes\": [");
+  for (i = k = 0; i < INSTRUMENT_CLASSES; ++i)
+    {
+      if (!counter[i][INSTRUMENT_TRAJECTORIES])
+        continue;
+      fprintf (file, "%s\n    {\"diameter_min\": %lg", k++ ? "," : "",
+               i * INSTRUMENT_CLASS_WIDTH);
+      if (i < INSTRUMENT_CLASSES - 1)
+        fprintf (file, ", \"diameter_max\": %lg",
+                 (i + 1) * INSTRUMENT_CLASS_WIDTH);
+      instrument_write_class (file, counter[i], time[i]);
+      fprintf (file, "}");
+    }
+  fprintf (file, "\n  ]\n}\n");
+  fclose (file);
+}
+
+#endif
@@ -0,0 +1,95 @@
+/*
+Sprinkler: a software to calculate drop trajectories in sprinkler irrigation.
+
+AUTHORS: Javier Burguete.
+
+Copyright 2012-2015, AUTHORS.
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+	1. Redistributions of source code must retain the above copyright notice,
+		this list of conditions and the following disclaimer.
+
+	2. Redistributions in binary form must reproduce the above copyright notice,
+		this list of conditions and the following disclaimer in the
+		documentation and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY AUTHORS ``AS IS'' AND ANY EXPRESS OR IMPLIED
+WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+SHALL AUTHORS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+
+/**
+ * \file instrument.h
+ * \brief Header file to count the calls of the hot path functions and to time
+ *   the phases of the drop trajectories. The instrumentation is compiled only
+ *   with the INSTRUMENT macro set to 1.
+ * \author Javier Burguete Tolosa.
+ * \copyright Copyright 2012-2015 Javier Burguete Tolosa, all rights reserved.
+ */
+#ifndef INSTRUMENT__H
+#define INSTRUMENT__H 1
+
+#define INSTRUMENT_CLASSES 17
+///< number of drop diameter classes (the last one is for bigger drops).
+#define INSTRUMENT_CLASS_WIDTH 0.0005   ///< width of a drop diameter class.
+
+/**
+ * \enum InstrumentCounter
+ * \brief enum to define the instrumentation counters.
+ */
+enum InstrumentCounter
+{
+  INSTRUMENT_TRAJECTORIES = 0,  ///< calculated trajectories.
+  INSTRUMENT_RUNGE_KUTTA_4 = 1, ///< Runge-Kutta steps.
+  INSTRUMENT_DROP_MOVE = 2,     ///< drop_move calls.
+  INSTRUMENT_CFL_LIMITED = 3,   ///< time steps limited by the CFL number.
+  INSTRUMENT_DT_LIMITED = 4,    ///< time steps limited by the time step size.
+  INSTRUMENT_MEASUREMENT_TESTS = 5,     ///< measurement_write calls.
+  INSTRUMENT_MEASUREMENT_HITS = 6,      ///< drops hitting a measurement.
+  INSTRUMENT_COUNTERS = 7       ///< number of counters.
+};
+
+/**
+ * \enum InstrumentPhase
+ * \brief enum to define the timed phases of a trajectory.
+ */
+enum InstrumentPhase
+{
+  INSTRUMENT_JET = 0,           ///< jet phase.
+  INSTRUMENT_FLIGHT = 1,        ///< free flight.
+  INSTRUMENT_IMPACT = 2,        ///< impact correction.
+  INSTRUMENT_OUTPUT = 3,        ///< trajectory and measurement output.
+  INSTRUMENT_PHASES = 4         ///< number of phases.
+};
+
+/**
+ * \struct Instrument
+ * \brief struct to define the instrumentation data of a thread.
+ */
+typedef struct
+{
+  unsigned long long int counter[INSTRUMENT_CLASSES][INSTRUMENT_COUNTERS];
+  ///< counters by drop diameter class.
+  unsigned long long int time[INSTRUMENT_CLASSES][INSTRUMENT_PHASES];
+  ///< phase times in nanoseconds by drop diameter class.
+  unsigned int class;           ///< current drop diameter class.
+} Instrument;
+
+Instrument *instrument_get ();
+unsigned long long int instrument_time ();
+void instrument_trajectory (double diameter);
+void instrument_count (unsigned int counter);
+void instrument_phase (unsigned int phase, unsigned long long int time);
+void instrument_write ();
+
+#endif
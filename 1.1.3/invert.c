@@ -55,6 +55,20 @@ invert_error (char *message)
   error_message = g_strconcat (gettext ("Invert file"), ": ", message, NULL);
 }
 
+int
+invert_run_node (Trajectory * t, Air * a, Jet * j, gsl_rng * rng,
+                 xmlNode * node, char *result)
+{
+  if (!trajectory_open_xml (t, a, node, result))
+    return 0;
+  trajectory_init (t, a, rng);
+  air_wind_uncertainty (a, rng);
+  //drop_print_parabolic (t->drop);
+  trajectory_invert_with_jet (t, a, j);
+  //drop_print_ballistic (t->drop);
+  return 1;
+}
+
 int
 invert_run_xml (xmlNode * node, Air * a, Trajectory * t, Jet * j, char *result)
 {
@@ -73,15 +87,8 @@ invert_run_xml (xmlNode * node, Air * a, Trajectory * t, Jet * j, char *result)
   if (!jet_open_xml (j, node))
     goto exit_on_error;
   for (node = node->next; node; node = node->next)
-    {
-      if (!trajectory_open_xml (t, a, node, result))
-        goto exit_on_error;
-      trajectory_init (t, a, rng);
-      air_wind_uncertainty (a, rng);
-      //drop_print_parabolic (t->drop);
-      trajectory_invert_with_jet (t, a, j);
-      //drop_print_ballistic (t->drop);
-    }
+    if (!invert_run_node (t, a, j, rng, node, result))
+      goto exit_on_error;
   gsl_rng_free (rng);
   return 1;
 
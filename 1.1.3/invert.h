@@ -37,6 +37,8 @@ OF SUCH DAMAGE.
 #define INVERT__H 1
 
 void invert_error (char *message);
+int invert_run_node (Trajectory * t, Air * a, Jet * j, gsl_rng * rng,
+                     xmlNode * node, char *result);
 int invert_run_xml (xmlNode * node, Air * a, Trajectory * t, Jet * j,
                     char *result);
 
@@ -0,0 +1,414 @@
+/*
+Sprinkler: a software to calculate drop trajectories in sprinkler irrigation.
+
+AUTHORS: Javier Burguete.
+
+Copyright 2012-2015, AUTHORS.
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+	1. Redistributions of source code must retain the above copyright notice,
+		this list of conditions and the following disclaimer.
+
+	2. Redistributions in binary form must reproduce the above copyright notice,
+		this list of conditions and the following disclaimer in the
+		documentation and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY AUTHORS ``AS IS'' AND ANY EXPRESS OR IMPLIED
+WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+SHALL AUTHORS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+
+/**
+ * \file layout.c
+ * \brief Source file to overlap the pattern of a sprinkler on a solid-set
+ *   layout. The pattern is a regular grid of depths written as rows of x, y
+ *   and depth with the y coordinate changing first, as the radial pattern
+ *   grids. The overlapped depths are the periodic tiling of the pattern on the
+ *   sprinkler lattice, calculated on a layout cell.
+ * \author Javier Burguete Tolosa.
+ * \copyright Copyright 2012-2015 Javier Burguete Tolosa, all rights reserved.
+ */
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <libxml/parser.h>
+#include <glib.h>
+#include <libintl.h>
+#include "config.h"
+#include "utils.h"
+#include "layout.h"
+
+#define DEBUG_LAYOUT 0          ///< macro to debug layout functions.
+
+/**
+ * \fn void layout_error (char *message)
+ * \brief function to show an error message opening a Layout struct.
+ * \param message
+ * \brief error message.
+ */
+void
+layout_error (char *message)
+{
+  error_message = g_strconcat (gettext ("Layout file"), ": ", message, NULL);
+}
+
+/**
+ * \fn double layout_pattern (Layout * l, double x, double y)
+ * \brief function to interpolate the depth of the sprinkler pattern.
+ * \param l
+ * \brief Layout struct.
+ * \param x
+ * \brief x coordinate to the sprinkler.
+ * \param y
+ * \brief y coordinate to the sprinkler.
+ * \return bilinearly interpolated depth (0 out of the grid area, its edges
+ *   included in the area).
+ */
+double
+layout_pattern (Layout * l, double x, double y)
+{
+  double *d;
+  double u, v;
+  int i, j;
+  u = (x - l->x0) / l->dx;
+  v = (y - l->y0) / l->dy;
+  if (u < 0. || v < 0. || u > l->nx - 1 || v > l->ny - 1)
+    return 0.;
+
+  // the last grid row and column are interpolated on their previous cells
+  i = MIN ((int) floor (u), (int) l->nx - 2);
+  j = MIN ((int) floor (v), (int) l->ny - 2);
+  u -= i;
+  v -= j;
+  d = l->depth + i * l->ny + j;
+  return (1. - u) * ((1. - v) * d[0] + v * d[1])
+    + u * ((1. - v) * d[l->ny] + v * d[l->ny + 1]);
+}
+
+/**
+ * \fn double layout_overlap (Layout * l, double sx, double sy, double x, \
+ *   double y)
+ * \brief function to calculate the overlapped depth on a point of a layout
+ *   with a sprinkler on the origin, adding the patterns of all the sprinklers
+ *   reaching the point.
+ * \param l
+ * \brief Layout struct.
+ * \param sx
+ * \brief spacing between sprinklers.
+ * \param sy
+ * \brief spacing between lines.
+ * \param x
+ * \brief x coordinate of the point.
+ * \param y
+ * \brief y coordinate of the point.
+ * \return overlapped depth.
+ */
+double
+layout_overlap (Layout * l, double sx, double sy, double x, double y)
+{
+  double depth, offset;
+  int i, j, imin, imax, jmin, jmax;
+  jmin = (int) ceil ((y - l->y0 - (l->ny - 1) * l->dy) / sy);
+  jmax = (int) floor ((y - l->y0) / sy);
+  for (j = jmin, depth = 0.; j <= jmax; ++j)
+    {
+      offset = (l->arrangement == LAYOUT_ARRANGEMENT_TRIANGULAR && (j & 1))
+        ? 0.5 * sx : 0.;
+      imin = (int) ceil ((x - offset - l->x0 - (l->nx - 1) * l->dx) / sx);
+      imax = (int) floor ((x - offset - l->x0) / sx);
+      for (i = imin; i <= imax; ++i)
+        depth += layout_pattern (l, x - offset - i * sx, y - j * sy);
+    }
+  return depth;
+}
+
+/**
+ * \fn int layout_open_grid (Layout * l, char *name, double x, double y)
+ * \brief function to open the grid of the sprinkler pattern.
+ * \param l
+ * \brief Layout struct.
+ * \param name
+ * \brief grid file name.
+ * \param x
+ * \brief x coordinate of the sprinkler on the grid.
+ * \param y
+ * \brief y coordinate of the sprinkler on the grid.
+ * \return 1 on success, 0 on error.
+ */
+int
+layout_open_grid (Layout * l, char *name, double x, double y)
+{
+  FILE *file;
+  double *p;
+  double r[3];
+  unsigned int i, j, n;
+#if DEBUG_LAYOUT
+  fprintf (stderr, "layout_open_grid: start\n");
+#endif
+  file = fopen (name, "r");
+  if (!file)
+    {
+      layout_error (gettext ("unable to open the grid file"));
+      goto exit_on_error;
+    }
+  for (n = 0, p = NULL; fscanf (file, "%lf%lf%lf", r, r + 1, r + 2) == 3; ++n)
+    {
+      p = g_realloc (p, 3 * (n + 1) * sizeof (double));
+      memcpy (p + 3 * n, r, 3 * sizeof (double));
+    }
+  fclose (file);
+  if (n < 4)
+    goto bad_grid;
+  for (l->ny = 0; l->ny < n && p[3 * l->ny] == p[0]; ++l->ny);
+  if (l->ny < 2 || n % l->ny || n / l->ny < 2)
+    goto bad_grid;
+  l->nx = n / l->ny;
+  l->x0 = p[0] - x;
+  l->y0 = p[1] - y;
+  l->dx = p[3 * l->ny] - p[0];
+  l->dy = p[4] - p[1];
+  if (l->dx <= 0. || l->dy <= 0.)
+    goto bad_grid;
+  l->depth = (double *) g_malloc (n * sizeof (double));
+  for (i = 0; i < l->nx; ++i)
+    for (j = 0; j < l->ny; ++j)
+      {
+        r[0] = p[3 * (i * l->ny + j)] - x - l->x0 - i * l->dx;
+        r[1] = p[3 * (i * l->ny + j) + 1] - y - l->y0 - j * l->dy;
+        if (fabs (r[0]) > 1e-6 * l->dx || fabs (r[1]) > 1e-6 * l->dy)
+          {
+            g_free (l->depth);
+            l->depth = NULL;
+            goto bad_grid;
+          }
+        l->depth[i * l->ny + j] = p[3 * (i * l->ny + j) + 2];
+      }
+  g_free (p);
+#if DEBUG_LAYOUT
+  fprintf (stderr, "layout_open_grid: end\n");
+#endif
+  return 1;
+
+bad_grid:
+  g_free (p);
+  layout_error (gettext ("bad grid"));
+
+exit_on_error:
+#if DEBUG_LAYOUT
+  fprintf (stderr, "layout_open_grid: end\n");
+#endif
+  return 0;
+}
+
+/**
+ * \fn int layout_open_xml (Layout * l, xmlNode * node)
+ * \brief function to open a Layout struct on a XML node.
+ * \param l
+ * \brief Layout struct.
+ * \param node
+ * \brief XML node.
+ * \return 1 on success, 0 on error.
+ */
+int
+layout_open_xml (Layout * l, xmlNode * node)
+{
+  xmlChar *buffer;
+  double x, y;
+  int k;
+#if DEBUG_LAYOUT
+  fprintf (stderr, "layout_open_xml: start\n");
+#endif
+  l->depth = l->spacing = NULL;
+  l->nspacings = 0;
+  if (xmlStrcmp (node->name, XML_LAYOUT))
+    {
+      layout_error (gettext ("bad label"));
+      goto exit_on_error;
+    }
+  x = xml_node_get_float_with_default (node, XML_X, 0., &k);
+  if (!k)
+    {
+      layout_error (gettext ("bad x"));
+      goto exit_on_error;
+    }
+  y = xml_node_get_float_with_default (node, XML_Y, 0., &k);
+  if (!k)
+    {
+      layout_error (gettext ("bad y"));
+      goto exit_on_error;
+    }
+  buffer = xmlGetProp (node, XML_ARRANGEMENT);
+  if (!buffer || !xmlStrcmp (buffer, XML_SQUARE))
+    l->arrangement = LAYOUT_ARRANGEMENT_SQUARE;
+  else if (!xmlStrcmp (buffer, XML_TRIANGULAR))
+    l->arrangement = LAYOUT_ARRANGEMENT_TRIANGULAR;
+  else
+    {
+      layout_error (gettext ("unknown arrangement"));
+      xmlFree (buffer);
+      goto exit_on_error;
+    }
+  xmlFree (buffer);
+  buffer = xmlGetProp (node, XML_GRID);
+  if (!buffer)
+    {
+      layout_error (gettext ("no grid file"));
+      goto exit_on_error;
+    }
+  k = layout_open_grid (l, (char *) buffer, x, y);
+  xmlFree (buffer);
+  if (!k)
+    goto exit_on_error;
+  for (node = node->children; node; node = node->next)
+    {
+      if (xmlStrcmp (node->name, XML_SPACING))
+        {
+          layout_error (gettext ("bad spacing label"));
+          goto exit_on_error;
+        }
+      x = xml_node_get_float (node, XML_X, &k);
+      if (!k || x <= 0.)
+        {
+          layout_error (gettext ("bad x spacing"));
+          goto exit_on_error;
+        }
+      y = xml_node_get_float_with_default (node, XML_Y, x, &k);
+      if (!k || y <= 0.)
+        {
+          layout_error (gettext ("bad y spacing"));
+          goto exit_on_error;
+        }
+      l->spacing
+        = g_realloc (l->spacing, 2 * (l->nspacings + 1) * sizeof (double));
+      l->spacing[2 * l->nspacings] = x;
+      l->spacing[2 * l->nspacings + 1] = y;
+      ++l->nspacings;
+    }
+  if (!l->nspacings)
+    {
+      layout_error (gettext ("no spacing"));
+      goto exit_on_error;
+    }
+#if DEBUG_LAYOUT
+  fprintf (stderr, "layout_open_xml: end\n");
+#endif
+  return 1;
+
+exit_on_error:
+#if DEBUG_LAYOUT
+  fprintf (stderr, "layout_open_xml: end\n");
+#endif
+  return 0;
+}
+
+/**
+ * \fn void layout_free (Layout * l)
+ * \brief function to free the memory used by a Layout struct.
+ * \param l
+ * \brief Layout struct.
+ */
+void
+layout_free (Layout * l)
+{
+  g_free (l->depth);
+  g_free (l->spacing);
+  l->depth = l->spacing = NULL;
+  l->nspacings = 0;
+}
+
+/**
+ * \fn int layout_run_xml (Layout * l, xmlNode * node, char *result)
+ * \brief function to overlap a sprinkler pattern on the layouts defined in a
+ *   XML node. The overlapped depths of every spacing are calculated on the
+ *   centers of a layout cell with the pattern grid resolution and written on
+ *   the file result-x_spacing-y_spacing, and the results file has a row by
+ *   spacing with the spacings, the mean depth, the standard deviation, the
+ *   Christiansen uniformity coefficient and the distribution uniformity of the
+ *   low quarter.
+ * \param l
+ * \brief Layout struct.
+ * \param node
+ * \brief XML node.
+ * \param result
+ * \brief results file name.
+ * \return 1 on success, 0 on error.
+ */
+int
+layout_run_xml (Layout * l, xmlNode * node, char *result)
+{
+  FILE *file, *file2;
+  char *name;
+  double *depth;
+  double sx, sy, x, y, mean, deviation, cu, du;
+  unsigned int i, j, k, nx, ny;
+#if DEBUG_LAYOUT
+  fprintf (stderr, "layout_run_xml: start\n");
+#endif
+  file = NULL;
+  if (!layout_open_xml (l, node))
+    goto exit_on_error;
+  file = fopen (result, "w");
+  if (!file)
+    {
+      layout_error (gettext ("unable to open the results file"));
+      goto exit_on_error;
+    }
+  for (k = 0; k < l->nspacings; ++k)
+    {
+      sx = l->spacing[2 * k];
+      sy = l->spacing[2 * k + 1];
+      nx = (unsigned int) ceil (sx / l->dx - 1e-6);
+      ny = (unsigned int) ceil (sy / l->dy - 1e-6);
+      name = g_strdup_printf ("%s-%lg-%lg", result, sx, sy);
+      file2 = fopen (name, "w");
+      g_free (name);
+      if (!file2)
+        {
+          layout_error (gettext ("unable to open the overlap file"));
+          goto exit_on_error;
+        }
+      depth = (double *) g_malloc (nx * ny * sizeof (double));
+      for (i = 0; i < nx; ++i)
+        {
+          x = (i + 0.5) * sx / nx;
+          for (j = 0; j < ny; ++j)
+            {
+              y = (j + 0.5) * sy / ny;
+              depth[i * ny + j] = layout_overlap (l, sx, sy, x, y);
+              fprintf (file2, "%lg %lg %lg\n", x, y, depth[i * ny + j]);
+            }
+          fprintf (file2, "\n");
+        }
+      fclose (file2);
+      uniformity (depth, nx * ny, &mean, &deviation, &cu, &du);
+      g_free (depth);
+      fprintf (file, "%lg %lg %lg %lg %lg %lg\n", sx, sy, mean, deviation, cu,
+               du);
+    }
+  fclose (file);
+  layout_free (l);
+#if DEBUG_LAYOUT
+  fprintf (stderr, "layout_run_xml: end\n");
+#endif
+  return 1;
+
+exit_on_error:
+  if (file)
+    fclose (file);
+  layout_free (l);
+#if DEBUG_LAYOUT
+  fprintf (stderr, "layout_run_xml: end\n");
+#endif
+  return 0;
+}
@@ -0,0 +1,80 @@
+/*
+Sprinkler: a software to calculate drop trajectories in sprinkler irrigation.
+
+AUTHORS: Javier Burguete.
+
+Copyright 2012-2015, AUTHORS.
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+	1. Redistributions of source code must retain the above copyright notice,
+		this list of conditions and the following disclaimer.
+
+	2. Redistributions in binary form must reproduce the above copyright notice,
+		this list of conditions and the following disclaimer in the
+		documentation and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY AUTHORS ``AS IS'' AND ANY EXPRESS OR IMPLIED
+WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+SHALL AUTHORS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+
+/**
+ * \file layout.h
+ * \brief Header file to overlap the pattern of a sprinkler on a solid-set
+ *   layout.
+ * \author Javier Burguete Tolosa.
+ * \copyright Copyright 2012-2015 Javier Burguete Tolosa, all rights reserved.
+ */
+#ifndef LAYOUT__H
+#define LAYOUT__H 1
+
+/**
+ * \enum LayoutArrangement
+ * \brief enum to define the arrangements of the sprinklers on a layout.
+ */
+enum LayoutArrangement
+{
+  LAYOUT_ARRANGEMENT_SQUARE = 0,
+  ///< sprinklers on a rectangular lattice.
+  LAYOUT_ARRANGEMENT_TRIANGULAR = 1
+    ///< lines of sprinklers shifted by a half spacing every other line.
+};
+
+/**
+ * \struct Layout
+ * \brief struct to define the overlap of a sprinkler pattern on layouts.
+ */
+typedef struct
+{
+  double *depth;                ///< array of depths of the pattern grid.
+  double *spacing;
+  ///< array of pairs of spacings between sprinklers and between lines.
+  double x0;                    ///< x of the first grid point to the sprinkler.
+  double y0;                    ///< y of the first grid point to the sprinkler.
+  double dx;                    ///< x step of the grid.
+  double dy;                    ///< y step of the grid.
+  unsigned int nx;              ///< number of grid points on x.
+  unsigned int ny;              ///< number of grid points on y.
+  unsigned int nspacings;       ///< number of spacings.
+  unsigned int arrangement;     ///< arrangement of the sprinklers.
+} Layout;
+
+void layout_error (char *message);
+double layout_pattern (Layout * l, double x, double y);
+double layout_overlap (Layout * l, double sx, double sy, double x, double y);
+int layout_open_grid (Layout * l, char *name, double x, double y);
+int layout_open_xml (Layout * l, xmlNode * node);
+void layout_free (Layout * l);
+int layout_run_xml (Layout * l, xmlNode * node, char *result);
+
+#endif
@@ -0,0 +1,249 @@
+/*
+Sprinkler: a software to calculate drop trajectories in sprinkler irrigation.
+
+AUTHORS: Javier Burguete.
+
+Copyright 2012-2015, AUTHORS.
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+	1. Redistributions of source code must retain the above copyright notice,
+		this list of conditions and the following disclaimer.
+
+	2. Redistributions in binary form must reproduce the above copyright notice,
+		this list of conditions and the following disclaimer in the
+		documentation and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY AUTHORS ``AS IS'' AND ANY EXPRESS OR IMPLIED
+WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+SHALL AUTHORS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+
+/**
+ * \file libsprinkler-check.c
+ * \brief File to check the public C interface of the library. The drops of a
+ *   batch file are calculated by libsprinkler_run with one and with several
+ *   threads, both results have to be equal, and they are written in the
+ *   format of the batch results to be compared with the reference.
+ * \author Javier Burguete Tolosa.
+ * \copyright Copyright 2012-2015 Javier Burguete Tolosa, all rights reserved.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "config.h"
+#include "libsprinkler.h"
+
+#define CHECK_LINE 512          ///< maximum length of a drops file row.
+
+/**
+ * \struct CheckDrops
+ * \brief struct to define the drops of a batch file.
+ */
+typedef struct
+{
+  double *input;                ///< array of drop initial data.
+  double *coefficient;          ///< array of drag resistance coefficients.
+  unsigned int *model;          ///< array of drag resistance models.
+  unsigned long int n;          ///< number of drops.
+} CheckDrops;
+
+/**
+ * \fn int check_read (CheckDrops * d, char *name)
+ * \brief function to read the drops of a batch file.
+ * \param d
+ * \brief CheckDrops struct.
+ * \param name
+ * \brief file name.
+ * \return 1 on success, 0 on error.
+ */
+int
+check_read (CheckDrops * d, char *name)
+{
+  char line[CHECK_LINE], model[CHECK_LINE];
+  FILE *file;
+  double *x, coefficient;
+  unsigned long int n;
+  int k;
+  d->input = d->coefficient = NULL;
+  d->model = NULL;
+  d->n = 0;
+  file = fopen (name, "r");
+  if (!file)
+    {
+      printf ("libsprinkler-check: unable to open %s\n", name);
+      return 0;
+    }
+  for (n = 0; fgets (line, CHECK_LINE, file);)
+    {
+      if (line[0] == '#' || line[0] == '\n')
+        continue;
+      d->input = (double *) realloc (d->input, (n + 1) * LIBSPRINKLER_INPUT
+                                     * sizeof (double));
+      d->coefficient = (double *) realloc (d->coefficient, (n + 1)
+                                           * sizeof (double));
+      d->model = (unsigned int *) realloc (d->model, (n + 1)
+                                           * sizeof (unsigned int));
+      x = d->input + n * LIBSPRINKLER_INPUT;
+      coefficient = 0.;
+      k = sscanf (line, "%lf,%lf,%lf,%lf,%lf,%lf,%lf,%[a-z],%lf", x, x + 1,
+                  x + 2, x + 3, x + 4, x + 5, x + 6, model, &coefficient);
+      if (k < 8)
+        break;
+      if (!strcmp (model, "constant") && k == 9)
+        d->model[n] = LIBSPRINKLER_DRAG_MODEL_CONSTANT;
+      else if (!strcmp (model, "sphere"))
+        d->model[n] = LIBSPRINKLER_DRAG_MODEL_SPHERE;
+      else if (!strcmp (model, "ovoid"))
+        d->model[n] = LIBSPRINKLER_DRAG_MODEL_OVOID;
+      else
+        break;
+      d->coefficient[n++] = coefficient;
+    }
+  d->n = n;
+  if (!feof (file))
+    {
+      printf ("libsprinkler-check: bad row %lu in %s\n", n + 1, name);
+      fclose (file);
+      return 0;
+    }
+  fclose (file);
+  return 1;
+}
+
+/**
+ * \fn int check_run (CheckDrops * d, LibsprinklerAir * a, double *output, \
+ *   unsigned int nthreads)
+ * \brief function to calculate the drops of a batch file with the library.
+ *   The library configuration has only a drag resistance model, so the drops
+ *   are calculated in groups with the same model and coefficient.
+ * \param d
+ * \brief CheckDrops struct.
+ * \param a
+ * \brief LibsprinklerAir struct.
+ * \param output
+ * \brief array of the drop results in the batch file order.
+ * \param nthreads
+ * \brief number of threads.
+ * \return 1 on success, 0 on error.
+ */
+int
+check_run (CheckDrops * d, LibsprinklerAir * a, double *output,
+           unsigned int nthreads)
+{
+  LibsprinklerConfig *c;
+  double *input, *result;
+  unsigned long int *row;
+  unsigned long int i, j, n;
+  char *done;
+  int k;
+  input = (double *) malloc (d->n * LIBSPRINKLER_INPUT * sizeof (double));
+  result = (double *) malloc (d->n * LIBSPRINKLER_OUTPUT * sizeof (double));
+  row = (unsigned long int *) malloc (d->n * sizeof (unsigned long int));
+  done = (char *) calloc (d->n, 1);
+  for (i = 0, k = 1; k && i < d->n; ++i)
+    {
+      if (done[i])
+        continue;
+      for (j = i, n = 0; j < d->n; ++j)
+        if (!done[j] && d->model[j] == d->model[i]
+            && d->coefficient[j] == d->coefficient[i])
+          {
+            memcpy (input + n * LIBSPRINKLER_INPUT,
+                    d->input + j * LIBSPRINKLER_INPUT,
+                    LIBSPRINKLER_INPUT * sizeof (double));
+            row[n++] = j;
+            done[j] = 1;
+          }
+      c = libsprinkler_config_new (0., 0.001, 0.1, d->model[i],
+                                   d->coefficient[i]);
+      k = c && libsprinkler_run (a, c, input, result, n, RANDOM_SEED,
+                                 nthreads);
+      libsprinkler_config_free (c);
+      for (j = 0; j < n; ++j)
+        memcpy (output + row[j] * LIBSPRINKLER_OUTPUT,
+                result + j * LIBSPRINKLER_OUTPUT,
+                LIBSPRINKLER_OUTPUT * sizeof (double));
+    }
+  free (done);
+  free (row);
+  free (result);
+  free (input);
+  return k;
+}
+
+/**
+ * \fn int main (int argn, char **argc)
+ * \brief main function.
+ * \param argn
+ * \brief arguments number.
+ * \param argc
+ * \brief argument strings.
+ * \return 0 if the results do not depend on the threads number, 1 if they do,
+ *   2 on error.
+ */
+int
+main (int argn, char **argc)
+{
+  CheckDrops d[1];
+  LibsprinklerAir *a;
+  FILE *file;
+  double *y1, *yn, *y;
+  unsigned long int i;
+  unsigned int nthreads;
+  int k;
+  if (argn != 4)
+    {
+      printf ("Usage of this program is:\n"
+              "\tlibsprinkler-check drops_file results_file threads_number\n");
+      return 2;
+    }
+  nthreads = atoi (argc[3]);
+  if (!check_read (d, argc[1]))
+    return 2;
+  a = libsprinkler_air_new (AIR_TEMPERATURE, AIR_PRESSURE, AIR_HUMIDITY,
+                            WIND_VELOCITY, WIND_ANGLE, WIND_HEIGHT,
+                            WIND_UNCERTAINTY);
+  y1 = (double *) malloc (d->n * LIBSPRINKLER_OUTPUT * sizeof (double));
+  yn = (double *) malloc (d->n * LIBSPRINKLER_OUTPUT * sizeof (double));
+  k = 2;
+  if (!a || !check_run (d, a, y1, 1) || !check_run (d, a, yn, nthreads))
+    {
+      printf ("libsprinkler-check: unable to calculate the drops\n");
+      goto exit_on_error;
+    }
+  file = fopen (argc[2], "w");
+  if (!file)
+    {
+      printf ("libsprinkler-check: unable to open %s\n", argc[2]);
+      goto exit_on_error;
+    }
+  for (i = 0; i < d->n; ++i)
+    {
+      y = y1 + i * LIBSPRINKLER_OUTPUT;
+      fprintf (file, "%lg %lg %lg %lg %lg %lg %lg %lg %lg\n", y[0], y[1],
+               y[2], y[3], y[4], y[5], y[6], y[7], y[8]);
+    }
+  fclose (file);
+  k = !!memcmp (y1, yn, d->n * LIBSPRINKLER_OUTPUT * sizeof (double));
+  printf ("%s libsprinkler 1 and %u threads\n", k ? "FAIL" : "PASS",
+          nthreads);
+
+exit_on_error:
+  free (yn);
+  free (y1);
+  libsprinkler_air_free (a);
+  free (d->model);
+  free (d->coefficient);
+  free (d->input);
+  return k;
+}
@@ -0,0 +1,334 @@
+/*
+Sprinkler: a software to calculate drop trajectories in sprinkler irrigation.
+
+AUTHORS: Javier Burguete.
+
+Copyright 2012-2015, AUTHORS.
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+	1. Redistributions of source code must retain the above copyright notice,
+		this list of conditions and the following disclaimer.
+
+	2. Redistributions in binary form must reproduce the above copyright notice,
+		this list of conditions and the following disclaimer in the
+		documentation and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY AUTHORS ``AS IS'' AND ANY EXPRESS OR IMPLIED
+WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+SHALL AUTHORS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+
+/**
+ * \file libsprinkler.c
+ * \brief Source file of the public C interface to calculate batches of drop
+ *   trajectories.
+ * \author Javier Burguete Tolosa.
+ * \copyright Copyright 2012-2015 Javier Burguete Tolosa, all rights reserved.
+ */
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <libxml/parser.h>
+#include <glib.h>
+#include <libintl.h>
+#include <gsl/gsl_rng.h>
+#include "config.h"
+#include "utils.h"
+#include "air.h"
+#include "drop.h"
+#include "measurement.h"
+#include "trajectory.h"
+#include "libsprinkler.h"
+
+#define DEBUG_LIBSPRINKLER 0    ///< macro to debug library functions.
+
+/**
+ * \struct _LibsprinklerAir
+ * \brief struct to define the atmosphere.
+ */
+struct _LibsprinklerAir
+{
+  Air air[1];                   ///< Air struct.
+};
+
+/**
+ * \struct _LibsprinklerConfig
+ * \brief struct to define the drops configuration.
+ */
+struct _LibsprinklerConfig
+{
+  double bed_level;             ///< bed level.
+  double dt;                    ///< numerical time step size.
+  double cfl;                   ///< stability number.
+  double drag_coefficient;
+  ///< drop drag resistance coefficient for the constant model.
+  unsigned int drag_model;      ///< drop drag resistance model.
+};
+
+/**
+ * \struct LibsprinklerThread
+ * \brief struct to define the data of a thread calculating a batch of drops.
+ */
+typedef struct
+{
+  LibsprinklerConfig *config;   ///< LibsprinklerConfig struct.
+  Air air[1];                   ///< Air struct copy.
+  Trajectory trajectory[1];     ///< Trajectory struct.
+  const double *input;          ///< array of drops.
+  double *output;               ///< array of drop results.
+  unsigned long int seed;       ///< pseudo-random numbers generator seed.
+  unsigned long int first;      ///< first drop.
+  unsigned long int last;       ///< last drop.
+  unsigned int error;           ///< 1 on a bad drop, 0 otherwise.
+} LibsprinklerThread;
+
+/**
+ * \fn LibsprinklerAir *libsprinkler_air_new (double temperature, \
+ *   double pressure, double humidity, double wind_velocity, \
+ *   double wind_angle, double wind_height, double wind_uncertainty)
+ * \brief function to create an atmosphere.
+ * \param temperature
+ * \brief air temperature in Celsius.
+ * \param pressure
+ * \brief air pressure.
+ * \param humidity
+ * \brief air relative humidity.
+ * \param wind_velocity
+ * \brief wind velocity.
+ * \param wind_angle
+ * \brief wind azimuth angle (in degrees).
+ * \param wind_height
+ * \brief reference height to measure the wind.
+ * \param wind_uncertainty
+ * \brief wind velocity uncertainty.
+ * \return LibsprinklerAir struct on success, NULL on error.
+ */
+LibsprinklerAir *
+libsprinkler_air_new (double temperature, double pressure, double humidity,
+                      double wind_velocity, double wind_angle,
+                      double wind_height, double wind_uncertainty)
+{
+  LibsprinklerAir *la;
+  Air *a;
+  if (!(temperature + KELVIN_TEMPERATURE > 0.) || !(pressure > 0.)
+      || !(humidity >= 0.) || !(humidity <= 100.) || !(wind_height > 0.)
+      || !(wind_uncertainty >= 0.))
+    return NULL;
+  la = (LibsprinklerAir *) g_malloc (sizeof (LibsprinklerAir));
+  a = la->air;
+  a->temperature = temperature;
+  a->pressure = pressure;
+  a->humidity = humidity;
+  a->velocity = wind_velocity;
+  a->uncertainty = wind_uncertainty;
+  a->angle = M_PI / 180. * wind_angle;
+  a->height = wind_height;
+  air_calculate (a);
+  return la;
+}
+
+/**
+ * \fn void libsprinkler_air_free (LibsprinklerAir * a)
+ * \brief function to free the memory used by an atmosphere.
+ * \param a
+ * \brief LibsprinklerAir struct.
+ */
+void
+libsprinkler_air_free (LibsprinklerAir * a)
+{
+  g_free (a);
+}
+
+/**
+ * \fn LibsprinklerConfig *libsprinkler_config_new (double bed_level, \
+ *   double dt, double cfl, unsigned int drag_model, double drag_coefficient)
+ * \brief function to create a drops configuration.
+ * \param bed_level
+ * \brief bed level.
+ * \param dt
+ * \brief numerical time step size.
+ * \param cfl
+ * \brief stability number.
+ * \param drag_model
+ * \brief drop drag resistance model (see ::LibsprinklerDragModel).
+ * \param drag_coefficient
+ * \brief drop drag resistance coefficient for the constant model.
+ * \return LibsprinklerConfig struct on success, NULL on error.
+ */
+LibsprinklerConfig *
+libsprinkler_config_new (double bed_level, double dt, double cfl,
+                         unsigned int drag_model, double drag_coefficient)
+{
+  LibsprinklerConfig *c;
+  if (!(dt > 0.) || !(cfl > 0.) || drag_model > LIBSPRINKLER_DRAG_MODEL_OVOID
+      || (drag_model == LIBSPRINKLER_DRAG_MODEL_CONSTANT
+          && !(drag_coefficient >= 0.)))
+    return NULL;
+  c = (LibsprinklerConfig *) g_malloc (sizeof (LibsprinklerConfig));
+  c->bed_level = bed_level;
+  c->dt = dt;
+  c->cfl = cfl;
+  c->drag_model = drag_model;
+  c->drag_coefficient = drag_coefficient;
+  return c;
+}
+
+/**
+ * \fn void libsprinkler_config_free (LibsprinklerConfig * c)
+ * \brief function to free the memory used by a drops configuration.
+ * \param c
+ * \brief LibsprinklerConfig struct.
+ */
+void
+libsprinkler_config_free (LibsprinklerConfig * c)
+{
+  g_free (c);
+}
+
+/**
+ * \fn static int libsprinkler_drop (LibsprinklerConfig * c, Air * a, \
+ *   Trajectory * t, gsl_rng * rng, unsigned long int seed, \
+ *   unsigned long int i, const double *x, double *y)
+ * \brief function to calculate the trajectory of a drop with its own
+ *   pseudo-random numbers substream.
+ * \param c
+ * \brief LibsprinklerConfig struct.
+ * \param a
+ * \brief Air struct.
+ * \param t
+ * \brief Trajectory struct.
+ * \param rng
+ * \brief GSL pseudo-random numbers generator struct.
+ * \param seed
+ * \brief pseudo-random numbers generator seed.
+ * \param i
+ * \brief drop number.
+ * \param x
+ * \brief array of the drop initial data.
+ * \param y
+ * \brief array of the final drop state.
+ * \return 1 on success, 0 on error.
+ */
+static int
+libsprinkler_drop (LibsprinklerConfig * c, Air * a, Trajectory * t,
+                   gsl_rng * rng, unsigned long int seed, unsigned long int i,
+                   const double *x, double *y)
+{
+  if (!(x[6] > 0.))
+    return 0;
+  t->drop->drag_model = c->drag_model;
+  t->drop->drag_coefficient = c->drag_coefficient;
+  gsl_rng_set (rng, random_seed (seed, i));
+  trajectory_landing (t, a, rng, x, c->bed_level, c->dt, c->cfl, y);
+  return 1;
+}
+
+/**
+ * \fn static gpointer libsprinkler_thread (LibsprinklerThread * data)
+ * \brief function to calculate the drops of a thread.
+ * \param data
+ * \brief LibsprinklerThread struct.
+ * \return NULL.
+ */
+static gpointer
+libsprinkler_thread (LibsprinklerThread * data)
+{
+  gsl_rng *rng;
+  unsigned long int i;
+  rng = gsl_rng_alloc (gsl_rng_taus);
+  data->error = 0;
+  for (i = data->first; i < data->last; ++i)
+    if (!libsprinkler_drop (data->config, data->air, data->trajectory, rng,
+                            data->seed, i, data->input + LIBSPRINKLER_INPUT * i,
+                            data->output + LIBSPRINKLER_OUTPUT * i))
+      {
+        data->error = 1;
+        break;
+      }
+  gsl_rng_free (rng);
+  return NULL;
+}
+
+/**
+ * \fn int libsprinkler_run (LibsprinklerAir * a, LibsprinklerConfig * c, \
+ *   const double *input, double *output, unsigned long int n, \
+ *   unsigned long int seed, unsigned int nthreads)
+ * \brief function to calculate a batch of drop trajectories. Every drop has
+ *   its own pseudo-random numbers substream, so the results do not depend on
+ *   the number of threads.
+ * \param a
+ * \brief LibsprinklerAir struct.
+ * \param c
+ * \brief LibsprinklerConfig struct.
+ * \param input
+ * \brief array of n x ::LIBSPRINKLER_INPUT drop initial data.
+ * \param output
+ * \brief array of n x ::LIBSPRINKLER_OUTPUT drop results.
+ * \param n
+ * \brief number of drops.
+ * \param seed
+ * \brief pseudo-random numbers generator seed.
+ * \param nthreads
+ * \brief number of threads.
+ * \return 1 on success, 0 on error.
+ */
+int
+libsprinkler_run (LibsprinklerAir * a, LibsprinklerConfig * c,
+                  const double *input, double *output, unsigned long int n,
+                  unsigned long int seed, unsigned int nthreads)
+{
+  LibsprinklerThread *data;
+  GThread **thread;
+  unsigned int i, m;
+  int error;
+#if DEBUG_LIBSPRINKLER
+  fprintf (stderr, "libsprinkler_run: start\n");
+#endif
+  if (!a || !c || (n && (!input || !output)))
+    return 0;
+  if (!n)
+    return 1;
+  m = MAX (1, MIN (nthreads, n));
+  data = (LibsprinklerThread *) g_malloc (m * sizeof (LibsprinklerThread));
+  thread = (GThread **) g_malloc (m * sizeof (GThread *));
+  for (i = 0; i < m; ++i)
+    {
+      data[i].config = c;
+      memcpy (data[i].air, a->air, sizeof (Air));
+      data[i].input = input;
+      data[i].output = output;
+      data[i].seed = seed;
+      data[i].first = n * i / m;
+      data[i].last = n * (i + 1) / m;
+    }
+  if (m == 1)
+    libsprinkler_thread (data);
+  else
+    {
+      for (i = 0; i < m; ++i)
+        thread[i] = g_thread_new (NULL, (GThreadFunc) libsprinkler_thread,
+                                  data + i);
+      for (i = 0; i < m; ++i)
+        g_thread_join (thread[i]);
+    }
+  for (i = error = 0; i < m; ++i)
+    error |= data[i].error;
+  g_free (thread);
+  g_free (data);
+#if DEBUG_LIBSPRINKLER
+  fprintf (stderr, "libsprinkler_run: end\n");
+#endif
+  return !error;
+}
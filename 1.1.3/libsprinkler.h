@@ -0,0 +1,84 @@
+/*
+Sprinkler: a software to calculate drop trajectories in sprinkler irrigation.
+
+AUTHORS: Javier Burguete.
+
+Copyright 2012-2015, AUTHORS.
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+	1. Redistributions of source code must retain the above copyright notice,
+		this list of conditions and the following disclaimer.
+
+	2. Redistributions in binary form must reproduce the above copyright notice,
+		this list of conditions and the following disclaimer in the
+		documentation and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY AUTHORS ``AS IS'' AND ANY EXPRESS OR IMPLIED
+WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+SHALL AUTHORS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+
+/**
+ * \file libsprinkler.h
+ * \brief Header file of the public C interface to calculate batches of drop
+ *   trajectories. The interface keeps no state between calls and has no file
+ *   input or output: the drops are read from and the results are written to
+ *   arrays provided by the caller. The linked code still defines the
+ *   thread-local error_message string and air_* atmosphere defaults used by
+ *   the program input functions; the interface functions neither read nor
+ *   write them, and the other globals are read-only function tables.
+ * \author Javier Burguete Tolosa.
+ * \copyright Copyright 2012-2015 Javier Burguete Tolosa, all rights reserved.
+ */
+#ifndef LIBSPRINKLER__H
+#define LIBSPRINKLER__H 1
+
+#define LIBSPRINKLER_INPUT 7
+///< number of values defining every drop: x, y, z, velocity, horizontal angle
+///< (in degrees), vertical angle (in degrees) and diameter.
+#define LIBSPRINKLER_OUTPUT 9
+///< number of results of every drop: time, x, y, z, x velocity, y velocity,
+///< z velocity, axis ratio and diameter.
+
+/**
+ * \enum LibsprinklerDragModel
+ * \brief enum to define the drop drag resistance models.
+ */
+enum LibsprinklerDragModel
+{
+  LIBSPRINKLER_DRAG_MODEL_CONSTANT = 0, ///< constant coefficient.
+  LIBSPRINKLER_DRAG_MODEL_SPHERE = 1,   ///< solid smooth sphere.
+  LIBSPRINKLER_DRAG_MODEL_OVOID = 2     ///< solid smooth ovoid.
+};
+
+typedef struct _LibsprinklerAir LibsprinklerAir;
+///< opaque struct to define the atmosphere.
+typedef struct _LibsprinklerConfig LibsprinklerConfig;
+///< opaque struct to define the drops configuration.
+
+LibsprinklerAir *libsprinkler_air_new (double temperature, double pressure,
+                                       double humidity, double wind_velocity,
+                                       double wind_angle, double wind_height,
+                                       double wind_uncertainty);
+void libsprinkler_air_free (LibsprinklerAir * a);
+LibsprinklerConfig *libsprinkler_config_new (double bed_level, double dt,
+                                             double cfl,
+                                             unsigned int drag_model,
+                                             double drag_coefficient);
+void libsprinkler_config_free (LibsprinklerConfig * c);
+int libsprinkler_run (LibsprinklerAir * a, LibsprinklerConfig * c,
+                      const double *input, double *output,
+                      unsigned long int n, unsigned long int seed,
+                      unsigned int nthreads);
+
+#endif
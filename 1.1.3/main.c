@@ -37,14 +37,21 @@ OF SUCH DAMAGE.
 #define _GNU_SOURCE
 #define HAVE_GTK 0
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <math.h>
 #include <libxml/parser.h>
+#include <libxml/xmlreader.h>
 #include <glib.h>
 #include <libintl.h>
 #include <gsl/gsl_rng.h>
+#include <gsl/gsl_vector.h>
+#if HAVE_MPI
+#include <mpi.h>
+#endif
 #include "config.h"
 #include "utils.h"
+#include "trace.h"
 #include "air.h"
 #include "drop.h"
 #include "measurement.h"
@@ -52,6 +59,28 @@ OF SUCH DAMAGE.
 #include "sprinkler.h"
 #include "jet.h"
 #include "invert.h"
+#include "sensitivity.h"
+#include "objective.h"
+#include "calibrate.h"
+#include "reader.h"
+#include "batch.h"
+#include "layout.h"
+#include "sweep.h"
+#include "server.h"
+
+#if HAVE_MPI
+
+/**
+ * \fn static void main_mpi_finalize (void)
+ * \brief function to finalize MPI at exit.
+ */
+static void
+main_mpi_finalize (void)
+{
+  MPI_Finalize ();
+}
+
+#endif
 
 /**
  * \fn int main (int argn, char **argc)
@@ -66,13 +95,95 @@ int
 main (int argn, char **argc)
 {
   Sprinkler sprinkler[1];
+  Sensitivity sensitivity[1];
+  Calibrate calibrate[1];
+  Batch batch[1];
+  Layout layout[1];
+  Sweep sweep[1];
   Jet jet[1];
   Trajectory trajectory[1];
   Air air[1];
-  xmlDoc *doc;
+  xmlTextReaderPtr reader;
   xmlNode *node;
+  int k;
+#if HAVE_MPI
+  MPI_Init (&argn, &argc);
+  MPI_Comm_rank (MPI_COMM_WORLD, &mpi_rank);
+  MPI_Comm_size (MPI_COMM_WORLD, &mpi_size);
+  atexit (main_mpi_finalize);
+#endif
   xmlKeepBlanksDefault (0);
-  if (argn == 2)
+  nthreads = g_get_num_processors ();
+  if (argn > 2 && !strcmp (argc[1], "-nthreads"))
+    {
+      nthreads = atoi (argc[2]);
+      if (!nthreads)
+        nthreads = 1;
+      argn -= 2;
+      argc += 2;
+    }
+  if (argn > 2 && !strcmp (argc[1], "-trace"))
+    {
+      trace_open (argc[2]);
+      argn -= 2;
+      argc += 2;
+    }
+  if (argn > 3 && !strcmp (argc[1], "-checkpoint"))
+    {
+      checkpoint_drops = atoi (argc[2]);
+      if (!checkpoint_drops)
+        checkpoint_drops = 1;
+      checkpoint_name = argc[3];
+      argn -= 3;
+      argc += 3;
+    }
+  else if (argn > 2 && !strcmp (argc[1], "-resume"))
+    {
+      checkpoint_name = argc[2];
+      checkpoint_resume = 1;
+      argn -= 2;
+      argc += 2;
+    }
+
+  // only the sprinkler files are distributed on MPI runs, every rank with its
+  // own checkpoint file, the rest run on the first rank alone
+  if (argn > 1 && argn < 4 && !strcmp (argc[1], "-server"))
+    {
+      // the checkpoint settings are global, so they would be shared by every
+      // request
+      if (checkpoint_name)
+        {
+          if (!mpi_rank)
+            {
+              error_message = g_strconcat
+                (gettext ("Unable to use checkpoints on the server"), NULL);
+              show_error ();
+            }
+          return 7;
+        }
+      if (mpi_size > 1)
+        {
+          if (!mpi_rank)
+            {
+              error_message = g_strconcat
+                (gettext ("Unable to run the server on several MPI ranks"),
+                 NULL);
+              show_error ();
+            }
+          return 7;
+        }
+      if (server_run (argn == 3 ? argc[2] : NULL))
+        return 0;
+      show_error ();
+      return 7;
+    }
+  if (argn != 3)
+    {
+      if (mpi_rank)
+        return 0;
+      mpi_size = 1;
+    }
+  if (argn == 2 && !checkpoint_name)
     {
       sprinkler_run_console (sprinkler, air, trajectory, argc[1]);
       return 0;
@@ -80,52 +191,113 @@ main (int argn, char **argc)
   else if (argn != 3)
     {
       printf ("Usage of this program is:\n"
-              "\tsprinkler [file_data] results_name\n");
+              "\tsprinkler [-nthreads N] [-trace trace_file] "
+              "[file_data] results_name\n"
+              "or, to checkpoint a sprinkler file run:\n"
+              "\tsprinkler [-nthreads N] [-trace trace_file] "
+              "-checkpoint drops_number checkpoint_file | "
+              "-resume checkpoint_file sprinkler_file results_name\n"
+              "or, to run a simulation server:\n"
+              "\tsprinkler [-nthreads N] [-trace trace_file] -server "
+              "[socket_name]\n");
       return 1;
     }
-  doc = xmlParseFile (argc[1]);
-  if (!doc)
+  reader = xmlReaderForFile (argc[1], NULL, XML_PARSE_NOBLANKS);
+  if (!reader)
     {
       error_message
         = g_strconcat (gettext ("Unable to parse the input file"), NULL);
       show_error ();
       return 2;
     }
-  node = xmlDocGetRootElement (doc);
-  if (!node)
+  while (xmlTextReaderRead (reader) == 1
+         && xmlTextReaderNodeType (reader) != XML_READER_TYPE_ELEMENT);
+  if (xmlTextReaderNodeType (reader) != XML_READER_TYPE_ELEMENT)
     {
       error_message = g_strconcat (gettext ("Bad input file"), NULL);
-      show_error ();
-      return 3;
+      k = 3;
+      goto exit_reader;
     }
-  if (!xmlStrcmp (node->name, XML_INVERT))
+  k = 0;
+  if (xmlStrcmp (xmlTextReaderConstName (reader), XML_SPRINKLER))
     {
-      if (invert_run_xml (node, air, trajectory, jet, argc[2]))
-        return 0;
-      show_error ();
-      return 3;
+      // the checkpoint settings are global, so every nested sprinkler run of
+      // the other files would share the same checkpoint file
+      if (checkpoint_name)
+        {
+          if (!mpi_rank)
+            {
+              error_message = g_strconcat
+                (gettext ("Checkpoints are only available on sprinkler files"),
+                 NULL);
+              k = 3;
+            }
+          goto exit_reader;
+        }
+      if (mpi_rank)
+        goto exit_reader;
+      mpi_size = 1;
+    }
+  if (mpi_size > 1 && checkpoint_name)
+    checkpoint_name = g_strdup_printf ("%s.%d", checkpoint_name, mpi_rank);
+
+  // inverse and trajectory files are streamed, the rest are expanded
+  if (!xmlStrcmp (xmlTextReaderConstName (reader), XML_INVERT))
+    {
+      if (!reader_run_invert (reader, air, trajectory, jet, argc[2]))
+        k = 3;
+    }
+  else if (!xmlStrcmp (xmlTextReaderConstName (reader), XML_TRAJECTORY))
+    {
+      if (!reader_run_trajectory (reader, trajectory, air, argc[2]))
+        k = 5;
+    }
+  else if (!(node = xmlTextReaderExpand (reader)))
+    {
+      error_message = g_strconcat (gettext ("Bad input file"), NULL);
+      k = 3;
     }
   else if (!xmlStrcmp (node->name, XML_SPRINKLER))
     {
-      if (sprinkler_run_xml (sprinkler, air, trajectory, node, argc[2]))
-        return 0;
-      show_error ();
-      return 4;
+      if (!sprinkler_run_xml (sprinkler, air, trajectory, node, argc[2]))
+        k = 4;
     }
-  else if (!xmlStrcmp (node->name, XML_TRAJECTORY))
+  else if (!xmlStrcmp (node->name, XML_BATCH))
     {
-      if (trajectory_run_xml (trajectory, air, node, argc[2]))
-        return 0;
-      show_error ();
-      return 5;
+      if (!batch_run_xml (batch, air, node, argc[2]))
+        k = 5;
+    }
+  else if (!xmlStrcmp (node->name, XML_LAYOUT))
+    {
+      if (!layout_run_xml (layout, node, argc[2]))
+        k = 5;
+    }
+  else if (!xmlStrcmp (node->name, XML_SWEEP))
+    {
+      if (!sweep_run_xml (sweep, node, argc[2]))
+        k = 4;
+    }
+  else if (!xmlStrcmp (node->name, XML_CALIBRATE))
+    {
+      if (!calibrate_run_xml (calibrate, node, argc[2]))
+        k = 4;
+    }
+  else if (!xmlStrcmp (node->name, XML_SENSITIVITY))
+    {
+      if (!sensitivity_run_xml (sensitivity, air, node, argc[2]))
+        k = 4;
     }
   else
     {
       error_message = g_strconcat (gettext ("Input file"), ": ",
                                    gettext ("Bad node"), NULL);
-      show_error ();
-      return 6;
+      k = 6;
     }
 
-  return 0;
+  // the expanded nodes belong to the reader, so it is released at the end
+exit_reader:
+  xmlFreeTextReader (reader);
+  if (k)
+    show_error ();
+  return k;
 }
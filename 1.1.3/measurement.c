@@ -46,6 +46,7 @@ OF SUCH DAMAGE.
 #endif
 #include "config.h"
 #include "utils.h"
+#include "instrument.h"
 #include "air.h"
 #include "drop.h"
 #include "measurement.h"
@@ -68,11 +69,77 @@ measurement_init (Measurement * m)
   m->xright = m->x + m->dx;
   m->ybottom = m->y - m->dy;
   m->ytop = m->y + m->dy;
+  m->volume = m->velocity = m->weight = m->weight2 = m->velocity_weight2
+    = m->velocity2 = 0.;
+  m->nhits = 0;
 #if DEBUG_MEASUREMENT
   fprintf (stderr, "measurement_init: end\n");
 #endif
 }
 
+/**
+ * \fn void measurement_add (Measurement * m, Measurement * m2)
+ * \brief function to add the collected drops of a measurement point copy.
+ * \param m
+ * \brief Measurement struct.
+ * \param m2
+ * \brief Measurement struct copy to add.
+ */
+void
+measurement_add (Measurement * m, Measurement * m2)
+{
+  m->volume += m2->volume;
+  m->velocity += m2->velocity;
+  m->weight += m2->weight;
+  m->weight2 += m2->weight2;
+  m->velocity_weight2 += m2->velocity_weight2;
+  m->velocity2 += m2->velocity2;
+  m->nhits += m2->nhits;
+}
+
+/**
+ * \fn void measurement_statistics (Measurement * m, unsigned int n, \
+ *   double z, double *frequency, double *frequency_error, double *velocity, \
+ *   double *velocity_error)
+ * \brief function to estimate the frequency of the collected drops and their
+ *   mean velocity with the half widths of their confidence intervals. The
+ *   variance of the mean velocity is the one of a ratio estimator, so the drop
+ *   statistical weights are accounted.
+ * \param m
+ * \brief Measurement struct.
+ * \param n
+ * \brief number of calculated drops.
+ * \param z
+ * \brief standard normal quantile of the confidence level.
+ * \param frequency
+ * \brief pointer to the frequency of the collected drops.
+ * \param frequency_error
+ * \brief pointer to the half width of the frequency confidence interval.
+ * \param velocity
+ * \brief pointer to the mean velocity of the collected drops.
+ * \param velocity_error
+ * \brief pointer to the half width of the mean velocity confidence interval.
+ */
+void
+measurement_statistics (Measurement * m, unsigned int n, double z,
+                        double *frequency, double *frequency_error,
+                        double *velocity, double *velocity_error)
+{
+  double v, variance;
+  *frequency = m->weight / n;
+  variance = (m->weight2 / n - *frequency * *frequency) / n;
+  *frequency_error = z * sqrt (fmax (variance, 0.));
+  if (!m->nhits)
+    {
+      *velocity = *velocity_error = 0.;
+      return;
+    }
+  *velocity = v = m->velocity / m->weight;
+  variance = (m->velocity2 - 2. * v * m->velocity_weight2
+              + v * v * m->weight2) / (m->weight * m->weight);
+  *velocity_error = z * sqrt (fmax (variance, 0.));
+}
+
 /**
  * \fn void measurement_error (char *message)
  * \brief function to show an error message opening a Measurement struct.
@@ -108,6 +175,7 @@ measurement_open_console (Measurement * m)
   scanf ("%lf", &(m->dx));
   printf ("Measurement dy: ");
   scanf ("%lf", &(m->dy));
+  m->convergence = 1;
   measurement_init (m);
 #if DEBUG_MEASUREMENT
   fprintf (stderr, "measurement_open_console: end\n");
@@ -165,6 +233,13 @@ measurement_open_xml (Measurement * m, xmlNode * node)
       measurement_error (gettext ("bad dy"));
       goto exit_on_error;
     }
+  m->convergence
+    = xml_node_get_uint_with_default (node, XML_CONVERGENCE, 1, &k);
+  if (!k || m->convergence > 1)
+    {
+      measurement_error (gettext ("bad convergence"));
+      goto exit_on_error;
+    }
   measurement_init (m);
 
 #if DEBUG_MEASUREMENT
@@ -180,8 +255,10 @@ exit_on_error:
 }
 
 /**
- * \fn void measurement_write (Measurement * m, Drop * d, double *rold)
- * \brief function to write on the measurement file the drop data.
+ * \fn void measurement_write (Measurement * m, Drop * d, double *rold, \
+ *   FILE * file)
+ * \brief function to collect a drop and to write on the measurement file the
+ *   drop data.
  * \param m
  * \brief Measurement struct.
  * \param d
@@ -189,15 +266,18 @@ exit_on_error:
  * \param rold
  * \brief old drop position vector.
  * \param file
- * \brief results file.
+ * \brief results file (NULL to only collect the drop).
  */
 void
 measurement_write (Measurement * m, Drop * d, double *rold, FILE * file)
 {
   double *rnew;
-  double x, y, dz;
+  double x, y, dz, v, w2;
 #if DEBUG_MEASUREMENT
   fprintf (stderr, "measurement_write: start\n");
+#endif
+#if INSTRUMENT
+  instrument_count (INSTRUMENT_MEASUREMENT_TESTS);
 #endif
   rnew = d->r;
   dz = (rold[2] - m->z) * (rnew[2] - m->z);
@@ -217,8 +297,23 @@ measurement_write (Measurement * m, Drop * d, double *rold, FILE * file)
 #endif
   if (y < m->ybottom || y > m->ytop)
     goto outside;
-  fprintf (file, "%lg %lg %lg %lg %lg %lg %lg\n",
-           m->x, m->y, m->z, d->diameter, d->v[0], d->v[1], d->v[2]);
+  ++m->nhits;
+#if INSTRUMENT
+  instrument_count (INSTRUMENT_MEASUREMENT_HITS);
+#endif
+  m->volume
+    += d->weight * M_PI / 6. * d->diameter * d->diameter * d->diameter;
+  v = vector_module (d->v[0], d->v[1], d->v[2]);
+  w2 = d->weight * d->weight;
+  m->velocity += d->weight * v;
+  m->weight += d->weight;
+  m->weight2 += w2;
+  m->velocity_weight2 += w2 * v;
+  m->velocity2 += w2 * v * v;
+  if (file)
+    fprintf (file, "%lg %lg %lg %lg %lg %lg %lg %lg\n",
+             m->x, m->y, m->z, d->diameter, d->v[0], d->v[1], d->v[2],
+             d->weight);
 
 outside:
 #if DEBUG_MEASUREMENT
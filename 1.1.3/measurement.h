@@ -51,9 +51,25 @@ typedef struct
   double xright;                ///< right boundary.
   double ytop;                  ///< top boundary.
   double ybottom;               ///< bottom boundary.
+  double volume;                ///< collected water volume.
+  double velocity;              ///< sum of the collected drop velocities.
+  double weight;                ///< sum of the collected drop weights.
+  double weight2;
+  ///< sum of the squared collected drop weights.
+  double velocity_weight2;
+  ///< sum of the collected drop velocities by the squared weights.
+  double velocity2;
+  ///< sum of the squared collected drop velocities by the squared weights.
+  unsigned long int nhits;      ///< number of collected drops.
+  unsigned int convergence;
+  ///< 1 if the measurement controls the convergence, 0 otherwise.
 } Measurement;
 
 void measurement_init (Measurement * m);
+void measurement_add (Measurement * m, Measurement * m2);
+void measurement_statistics (Measurement * m, unsigned int n, double z,
+                             double *frequency, double *frequency_error,
+                             double *velocity, double *velocity_error);
 void measurement_error (char *message);
 void measurement_open_console (Measurement * m);
 int measurement_open_xml (Measurement * m, xmlNode * node);
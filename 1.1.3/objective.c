@@ -0,0 +1,255 @@
+/*
+Sprinkler: a software to calculate drop trajectories in sprinkler irrigation.
+
+AUTHORS: Javier Burguete.
+
+Copyright 2012-2015, AUTHORS.
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+	1. Redistributions of source code must retain the above copyright notice,
+		this list of conditions and the following disclaimer.
+
+	2. Redistributions in binary form must reproduce the above copyright notice,
+		this list of conditions and the following disclaimer in the
+		documentation and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY AUTHORS ``AS IS'' AND ANY EXPRESS OR IMPLIED
+WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+SHALL AUTHORS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+
+/**
+ * \file objective.c
+ * \brief Source file to define the objective function to compare a simulated
+ *   drop trajectory with experimental data.
+ * \author Javier Burguete Tolosa.
+ * \copyright Copyright 2012-2015 Javier Burguete Tolosa, all rights reserved.
+ */
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include "objective.h"
+
+#define DEBUG_OBJECTIVE 0       ///< macro to debug objective functions.
+
+/**
+ * \fn static int objective_compare (const void *p1, const void *p2)
+ * \brief function to compare the x-coordinates of 2 measured points.
+ * \param p1
+ * \brief 1st ObjectivePoint struct.
+ * \param p2
+ * \brief 2nd ObjectivePoint struct.
+ * \return -1, 0 or 1 as the 1st point is before, equal or after the 2nd.
+ */
+static int
+objective_compare (const void *p1, const void *p2)
+{
+  double x1, x2;
+  x1 = ((const ObjectivePoint *) p1)->x;
+  x2 = ((const ObjectivePoint *) p2)->x;
+  return (x1 > x2) - (x1 < x2);
+}
+
+/**
+ * \fn static inline void objective_compare_point (Objective * o, double z)
+ * \brief function to add the squared error of the next measured point.
+ * \param o
+ * \brief Objective struct.
+ * \param z
+ * \brief simulated z-coordinate at the measured point.
+ */
+static inline void
+objective_compare_point (Objective * o, double z)
+{
+  z -= o->point[o->i].z;
+  o->error += z * z;
+  ++o->i;
+}
+
+/**
+ * \fn void objective_init (Objective * o)
+ * \brief function to init the comparison with a new trajectory.
+ * \param o
+ * \brief Objective struct.
+ */
+void
+objective_init (Objective * o)
+{
+#if DEBUG_OBJECTIVE
+  fprintf (stderr, "objective_init: start\n");
+#endif
+  o->error = 0.;
+  o->i = o->ntrajectory = 0;
+#if DEBUG_OBJECTIVE
+  fprintf (stderr, "objective_init: end\n");
+#endif
+}
+
+/**
+ * \fn int objective_open_profile (Objective * o, char *name, double scale)
+ * \brief function to open the measured profile in a file of x-z columns.
+ * \param o
+ * \brief Objective struct.
+ * \param name
+ * \brief file name.
+ * \param scale
+ * \brief scale factor to convert the file units to meters.
+ * \return 1 on success, 0 on error.
+ */
+int
+objective_open_profile (Objective * o, char *name, double scale)
+{
+  ObjectivePoint p;
+  FILE *file;
+#if DEBUG_OBJECTIVE
+  fprintf (stderr, "objective_open_profile: start\n");
+#endif
+  o->type = OBJECTIVE_TYPE_PROFILE;
+  o->point = NULL;
+  o->npoints = 0;
+  file = fopen (name, "r");
+  if (!file)
+    goto exit_on_error;
+  while (fscanf (file, "%lf%lf", &p.x, &p.z) == 2)
+    {
+      p.x *= scale;
+      p.z *= scale;
+      o->point
+        = realloc (o->point, (o->npoints + 1) * sizeof (ObjectivePoint));
+      o->point[o->npoints++] = p;
+    }
+  fclose (file);
+  if (!o->npoints)
+    goto exit_on_error;
+  qsort (o->point, o->npoints, sizeof (ObjectivePoint), objective_compare);
+  objective_init (o);
+#if DEBUG_OBJECTIVE
+  fprintf (stderr, "objective_open_profile: npoints=%u\n", o->npoints);
+  fprintf (stderr, "objective_open_profile: end\n");
+#endif
+  return 1;
+
+exit_on_error:
+#if DEBUG_OBJECTIVE
+  fprintf (stderr, "objective_open_profile: end\n");
+#endif
+  return 0;
+}
+
+/**
+ * \fn void objective_open_range (Objective * o, double range)
+ * \brief function to open an objective function on the drop range.
+ * \param o
+ * \brief Objective struct.
+ * \param range
+ * \brief measured range.
+ */
+void
+objective_open_range (Objective * o, double range)
+{
+  o->type = OBJECTIVE_TYPE_RANGE;
+  o->point = NULL;
+  o->npoints = 0;
+  o->range = range;
+  objective_init (o);
+}
+
+/**
+ * \fn void objective_add (Objective * o, double x, double z)
+ * \brief function to compare a new trajectory point with the measured points
+ *   in a single merge pass along the trajectory.
+ * \param o
+ * \brief Objective struct.
+ * \param x
+ * \brief trajectory x-coordinate.
+ * \param z
+ * \brief trajectory z-coordinate.
+ */
+void
+objective_add (Objective * o, double x, double z)
+{
+  double k;
+#if DEBUG_OBJECTIVE
+  fprintf (stderr, "objective_add: start\n");
+#endif
+  if (o->type == OBJECTIVE_TYPE_PROFILE)
+    {
+      if (!o->ntrajectory)
+        while (o->i < o->npoints && o->point[o->i].x < x)
+          objective_compare_point (o, z);
+      else if (x > o->xold)
+        {
+          k = (z - o->zold) / (x - o->xold);
+          while (o->i < o->npoints && o->point[o->i].x < x)
+            objective_compare_point (o,
+                                     o->zold + (o->point[o->i].x - o->xold) * k);
+        }
+      else
+        goto exit_add;
+    }
+  o->xold = x;
+  o->zold = z;
+  ++o->ntrajectory;
+
+exit_add:
+#if DEBUG_OBJECTIVE
+  fprintf (stderr, "objective_add: end\n");
+#endif
+  return;
+}
+
+/**
+ * \fn double objective_error (Objective * o)
+ * \brief function to finish the comparison with a trajectory.
+ * \param o
+ * \brief Objective struct.
+ * \return sum of squared errors.
+ */
+double
+objective_error (Objective * o)
+{
+  double k;
+#if DEBUG_OBJECTIVE
+  fprintf (stderr, "objective_error: start\n");
+#endif
+  if (!o->ntrajectory)
+    o->error = HUGE_VAL;
+  else if (o->type == OBJECTIVE_TYPE_RANGE)
+    {
+      k = o->xold - o->range;
+      o->error = k * k;
+    }
+  else
+    while (o->i < o->npoints)
+      objective_compare_point (o, o->zold);
+#if DEBUG_OBJECTIVE
+  fprintf (stderr, "objective_error: error=%le\n", o->error);
+  fprintf (stderr, "objective_error: end\n");
+#endif
+  return o->error;
+}
+
+/**
+ * \fn void objective_free (Objective * o)
+ * \brief function to free the memory used by an Objective struct.
+ * \param o
+ * \brief Objective struct.
+ */
+void
+objective_free (Objective * o)
+{
+  free (o->point);
+  o->point = NULL;
+  o->npoints = 0;
+}
@@ -0,0 +1,85 @@
+/*
+Sprinkler: a software to calculate drop trajectories in sprinkler irrigation.
+
+AUTHORS: Javier Burguete.
+
+Copyright 2012-2015, AUTHORS.
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+	1. Redistributions of source code must retain the above copyright notice,
+		this list of conditions and the following disclaimer.
+
+	2. Redistributions in binary form must reproduce the above copyright notice,
+		this list of conditions and the following disclaimer in the
+		documentation and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY AUTHORS ``AS IS'' AND ANY EXPRESS OR IMPLIED
+WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+SHALL AUTHORS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+
+/**
+ * \file objective.h
+ * \brief Header file to define the objective function to compare a simulated
+ *   drop trajectory with experimental data.
+ * \author Javier Burguete Tolosa.
+ * \copyright Copyright 2012-2015 Javier Burguete Tolosa, all rights reserved.
+ */
+#ifndef OBJECTIVE__H
+#define OBJECTIVE__H 1
+
+/**
+ * \enum ObjectiveType
+ * \brief enum to define the objective function types.
+ */
+enum ObjectiveType
+{
+  OBJECTIVE_TYPE_PROFILE = 0,   ///< squared errors on a measured profile.
+  OBJECTIVE_TYPE_RANGE = 1      ///< squared error on the measured range.
+};
+
+/**
+ * \struct ObjectivePoint
+ * \brief struct to define a measured point.
+ */
+typedef struct
+{
+  double x;                     ///< x-coordinate.
+  double z;                     ///< z-coordinate.
+} ObjectivePoint;
+
+/**
+ * \struct Objective
+ * \brief struct to define the objective function.
+ */
+typedef struct
+{
+  ObjectivePoint *point;        ///< array of measured points sorted by x.
+  double range;                 ///< measured range.
+  double xold;                  ///< last trajectory x-coordinate.
+  double zold;                  ///< last trajectory z-coordinate.
+  double error;                 ///< sum of squared errors.
+  unsigned int npoints;         ///< number of measured points.
+  unsigned int i;               ///< next measured point to compare.
+  unsigned int ntrajectory;     ///< number of compared trajectory points.
+  unsigned int type;            ///< objective function type.
+} Objective;
+
+void objective_init (Objective * o);
+int objective_open_profile (Objective * o, char *name, double scale);
+void objective_open_range (Objective * o, double range);
+void objective_add (Objective * o, double x, double z);
+double objective_error (Objective * o);
+void objective_free (Objective * o);
+
+#endif
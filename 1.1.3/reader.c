@@ -0,0 +1,234 @@
+/*
+Sprinkler: a software to calculate drop trajectories in sprinkler irrigation.
+
+AUTHORS: Javier Burguete.
+
+Copyright 2012-2015, AUTHORS.
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+	1. Redistributions of source code must retain the above copyright notice,
+		this list of conditions and the following disclaimer.
+
+	2. Redistributions in binary form must reproduce the above copyright notice,
+		this list of conditions and the following disclaimer in the
+		documentation and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY AUTHORS ``AS IS'' AND ANY EXPRESS OR IMPLIED
+WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+SHALL AUTHORS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+
+/**
+ * \file reader.c
+ * \brief Source file to run the input files with a streaming XML reader. Every
+ *   trajectory is expanded, calculated and released before parsing the next
+ *   one, so the used memory does not depend on the input file size.
+ * \author Javier Burguete Tolosa.
+ * \copyright Copyright 2012-2015 Javier Burguete Tolosa, all rights reserved.
+ */
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <math.h>
+#include <libxml/parser.h>
+#include <libxml/xmlreader.h>
+#include <glib.h>
+#include <libintl.h>
+#include <gsl/gsl_rng.h>
+#include "config.h"
+#include "utils.h"
+#include "air.h"
+#include "drop.h"
+#include "measurement.h"
+#include "trajectory.h"
+#include "jet.h"
+#include "invert.h"
+#include "reader.h"
+
+#define DEBUG_READER 0          ///< macro to debug reader functions.
+
+/**
+ * \fn void reader_error (char *message)
+ * \brief function to show an error message reading an input file.
+ * \param message
+ * \brief error message.
+ */
+void
+reader_error (char *message)
+{
+  error_message = g_strconcat (gettext ("Input file"), ": ", message, NULL);
+}
+
+/**
+ * \fn xmlNode * reader_next (xmlTextReaderPtr reader, int *error_code)
+ * \brief function to expand the next child element of the root XML node. The
+ *   reader has to be on the root node or on the last expanded child, which is
+ *   released.
+ * \param reader
+ * \brief XML reader.
+ * \param error_code
+ * \brief error code.
+ * \return next child XML node or NULL at the end of the root node or on error.
+ */
+xmlNode *
+reader_next (xmlTextReaderPtr reader, int *error_code)
+{
+  xmlNode *node;
+  int k;
+  *error_code = 1;
+  if (!xmlTextReaderDepth (reader))
+    {
+      if (xmlTextReaderIsEmptyElement (reader))
+        return NULL;
+      k = xmlTextReaderRead (reader);
+    }
+  else
+    k = xmlTextReaderNext (reader);
+  for (; k == 1; k = xmlTextReaderNext (reader))
+    {
+      if (xmlTextReaderDepth (reader) < 1)
+        return NULL;
+      if (xmlTextReaderNodeType (reader) == XML_READER_TYPE_ELEMENT)
+        {
+          node = xmlTextReaderExpand (reader);
+          if (!node)
+            break;
+          return node;
+        }
+    }
+  if (k)
+    *error_code = 0;
+  return NULL;
+}
+
+/**
+ * \fn int reader_run_trajectory (xmlTextReaderPtr reader, Trajectory * t, \
+ *   Air * a, char *result)
+ * \brief function to calculate the trajectories of a streamed input file.
+ * \param reader
+ * \brief XML reader on the root node.
+ * \param t
+ * \brief Trajectory struct.
+ * \param a
+ * \brief Air struct.
+ * \param result
+ * \brief result file name.
+ * \return 1 on success, 0 on error.
+ */
+int
+reader_run_trajectory (xmlTextReaderPtr reader, Trajectory * t, Air * a,
+                       char *result)
+{
+  xmlNode *node;
+  gsl_rng *rng;
+  int k;
+#if DEBUG_READER
+  fprintf (stderr, "reader_run_trajectory: start\n");
+#endif
+  rng = gsl_rng_alloc (gsl_rng_taus);
+  gsl_rng_set (rng, RANDOM_SEED);
+  node = reader_next (reader, &k);
+  if (!node)
+    {
+      reader_error (gettext ("no air"));
+      goto exit_on_error;
+    }
+  if (!air_open_xml (a, node))
+    goto exit_on_error;
+  while ((node = reader_next (reader, &k)))
+    if (!trajectory_run_node (t, a, rng, node, result))
+      goto exit_on_error;
+  if (!k)
+    {
+      reader_error (gettext ("bad XML"));
+      goto exit_on_error;
+    }
+  gsl_rng_free (rng);
+#if DEBUG_READER
+  fprintf (stderr, "reader_run_trajectory: end\n");
+#endif
+  return 1;
+
+exit_on_error:
+  gsl_rng_free (rng);
+#if DEBUG_READER
+  fprintf (stderr, "reader_run_trajectory: end\n");
+#endif
+  return 0;
+}
+
+/**
+ * \fn int reader_run_invert (xmlTextReaderPtr reader, Air * a, \
+ *   Trajectory * t, Jet * j, char *result)
+ * \brief function to calculate the inverse trajectories of a streamed input
+ *   file.
+ * \param reader
+ * \brief XML reader on the root node.
+ * \param a
+ * \brief Air struct.
+ * \param t
+ * \brief Trajectory struct.
+ * \param j
+ * \brief Jet struct.
+ * \param result
+ * \brief result file name.
+ * \return 1 on success, 0 on error.
+ */
+int
+reader_run_invert (xmlTextReaderPtr reader, Air * a, Trajectory * t, Jet * j,
+                   char *result)
+{
+  xmlNode *node;
+  gsl_rng *rng;
+  int k;
+#if DEBUG_READER
+  fprintf (stderr, "reader_run_invert: start\n");
+#endif
+  rng = gsl_rng_alloc (gsl_rng_taus);
+  gsl_rng_set (rng, RANDOM_SEED);
+  node = reader_next (reader, &k);
+  if (!node)
+    {
+      invert_error (gettext ("No air"));
+      goto exit_on_error;
+    }
+  if (!air_open_xml (a, node))
+    goto exit_on_error;
+  node = reader_next (reader, &k);
+  if (!node)
+    {
+      invert_error (gettext ("No jet"));
+      goto exit_on_error;
+    }
+  if (!jet_open_xml (j, node))
+    goto exit_on_error;
+  while ((node = reader_next (reader, &k)))
+    if (!invert_run_node (t, a, j, rng, node, result))
+      goto exit_on_error;
+  if (!k)
+    {
+      reader_error (gettext ("bad XML"));
+      goto exit_on_error;
+    }
+  gsl_rng_free (rng);
+#if DEBUG_READER
+  fprintf (stderr, "reader_run_invert: end\n");
+#endif
+  return 1;
+
+exit_on_error:
+  gsl_rng_free (rng);
+#if DEBUG_READER
+  fprintf (stderr, "reader_run_invert: end\n");
+#endif
+  return 0;
+}
@@ -0,0 +1,469 @@
+/*
+Sprinkler: a software to calculate drop trajectories in sprinkler irrigation.
+
+AUTHORS: Javier Burguete.
+
+Copyright 2012-2015, AUTHORS.
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+	1. Redistributions of source code must retain the above copyright notice,
+		this list of conditions and the following disclaimer.
+
+	2. Redistributions in binary form must reproduce the above copyright notice,
+		this list of conditions and the following disclaimer in the
+		documentation and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY AUTHORS ``AS IS'' AND ANY EXPRESS OR IMPLIED
+WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+SHALL AUTHORS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+
+/**
+ * \file sensitivity.c
+ * \brief Source file to calculate the sensitivities of the sprinkler results
+ *   to the sprinkler parameters.
+ * \author Javier Burguete Tolosa.
+ * \copyright Copyright 2012-2015 Javier Burguete Tolosa, all rights reserved.
+ */
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <libxml/parser.h>
+#include <glib.h>
+#include <libintl.h>
+#include <gsl/gsl_rng.h>
+#include "config.h"
+#include "utils.h"
+#include "trace.h"
+#include "air.h"
+#include "drop.h"
+#include "measurement.h"
+#include "trajectory.h"
+#include "sprinkler.h"
+#include "sensitivity.h"
+
+#define DEBUG_SENSITIVITY 0     ///< macro to debug sensitivity functions.
+
+/**
+ * \var sensitivity_variable_name
+ * \brief array of the perturbed parameter names.
+ */
+static const xmlChar *sensitivity_variable_name[4] = {
+  XML_JET_TIME, XML_PRESSURE, XML_VERTICAL_ANGLE, XML_MAXIMUM_DROP_DIAMETER
+};
+
+/**
+ * \fn void sensitivity_error (char *message)
+ * \brief function to show an error message opening a Sensitivity struct.
+ * \param message
+ * \brief error message.
+ */
+void
+sensitivity_error (char *message)
+{
+  error_message = g_strconcat (gettext ("Sensitivity"), ": ", message, NULL);
+}
+
+/**
+ * \fn void sensitivity_perturb (Sprinkler * s, unsigned int variable, \
+ *   double step)
+ * \brief function to perturb a sprinkler parameter.
+ * \param s
+ * \brief Sprinkler struct.
+ * \param variable
+ * \brief perturbed parameter type.
+ * \param step
+ * \brief perturbation step.
+ */
+void
+sensitivity_perturb (Sprinkler * s, unsigned int variable, double step)
+{
+  switch (variable)
+    {
+    case SENSITIVITY_VARIABLE_JET_TIME:
+      s->jet_time += step;
+      break;
+    case SENSITIVITY_VARIABLE_PRESSURE:
+      s->pressure += step;
+      break;
+    case SENSITIVITY_VARIABLE_VERTICAL_ANGLE:
+      s->vertical_angle += step;
+      break;
+    default:
+      s->drop_dmax += step;
+    }
+}
+
+/**
+ * \fn void sensitivity_free (Sensitivity * s)
+ * \brief function to free the memory used by a Sensitivity struct.
+ * \param s
+ * \brief Sensitivity struct.
+ */
+void
+sensitivity_free (Sensitivity * s)
+{
+  unsigned int i;
+  for (i = 0; i < s->ncases; ++i)
+    sprinkler_free (s->sprinkler + i);
+  g_free (s->sprinkler);
+  g_free (s->step);
+  g_free (s->variable);
+  s->sprinkler = NULL;
+  s->step = NULL;
+  s->variable = NULL;
+  s->nvariables = s->ncases = 0;
+}
+
+/**
+ * \fn int sensitivity_open_xml (Sensitivity * s, Air * a, xmlNode * node)
+ * \brief function to open a Sensitivity struct on a XML node.
+ * \param s
+ * \brief Sensitivity struct.
+ * \param a
+ * \brief Air struct.
+ * \param node
+ * \brief XML node.
+ * \return 1 on success, 0 on error.
+ */
+int
+sensitivity_open_xml (Sensitivity * s, Air * a, xmlNode * node)
+{
+  xmlChar *buffer;
+  unsigned int i, j;
+  int k;
+#if DEBUG_SENSITIVITY
+  fprintf (stderr, "sensitivity_open_xml: start\n");
+#endif
+  s->sprinkler = NULL;
+  s->step = NULL;
+  s->variable = NULL;
+  s->nvariables = s->ncases = 0;
+  if (xmlStrcmp (node->name, XML_SENSITIVITY))
+    {
+      sensitivity_error (gettext ("bad label"));
+      goto exit_on_error;
+    }
+  buffer = xmlGetProp (node, XML_SCHEME);
+  if (!buffer || !xmlStrcmp (buffer, XML_FORWARD))
+    s->scheme = SENSITIVITY_SCHEME_FORWARD;
+  else if (!xmlStrcmp (buffer, XML_CENTRAL))
+    s->scheme = SENSITIVITY_SCHEME_CENTRAL;
+  else
+    {
+      sensitivity_error (gettext ("unknown scheme"));
+      xmlFree (buffer);
+      goto exit_on_error;
+    }
+  xmlFree (buffer);
+  node = node->children;
+  if (!node)
+    {
+      sensitivity_error (gettext ("no sprinkler"));
+      goto exit_on_error;
+    }
+  s->sprinkler = (Sprinkler *) g_malloc (sizeof (Sprinkler));
+  s->ncases = 1;
+  if (!sprinkler_open_xml (s->sprinkler, a, node))
+    goto exit_on_error;
+  if (!s->sprinkler->ntrajectories)
+    {
+      sensitivity_error (gettext ("bad drops number"));
+      goto exit_on_error;
+    }
+  for (node = node->next; node; node = node->next)
+    {
+      if (xmlStrcmp (node->name, XML_VARIABLE))
+        {
+          sensitivity_error (gettext ("bad variable label"));
+          goto exit_on_error;
+        }
+      buffer = xmlGetProp (node, XML_NAME);
+      for (i = 0; i < 4; ++i)
+        if (buffer && !xmlStrcmp (buffer, sensitivity_variable_name[i]))
+          break;
+      xmlFree (buffer);
+      if (i == 4)
+        {
+          sensitivity_error (gettext ("unknown variable"));
+          goto exit_on_error;
+        }
+      s->variable = (unsigned int *)
+        g_realloc (s->variable, (s->nvariables + 1) * sizeof (unsigned int));
+      s->step = (double *)
+        g_realloc (s->step, (s->nvariables + 1) * sizeof (double));
+      s->variable[s->nvariables] = i;
+      s->step[s->nvariables] = xml_node_get_float (node, XML_STEP, &k);
+      if (!k || s->step[s->nvariables] == 0.)
+        {
+          sensitivity_error (gettext ("bad step"));
+          goto exit_on_error;
+        }
+      ++s->nvariables;
+    }
+  if (!s->nvariables)
+    {
+      sensitivity_error (gettext ("no variables"));
+      goto exit_on_error;
+    }
+
+  // base case followed by the positive and, for central differences, the
+  // negative perturbations
+  j = (s->scheme == SENSITIVITY_SCHEME_CENTRAL) ? 2 : 1;
+  s->sprinkler = (Sprinkler *)
+    g_realloc (s->sprinkler, (1 + j * s->nvariables) * sizeof (Sprinkler));
+  for (i = 0; i < j * s->nvariables; ++i, ++s->ncases)
+    {
+      sprinkler_copy (s->sprinkler + s->ncases, s->sprinkler);
+      sensitivity_perturb (s->sprinkler + s->ncases,
+                           s->variable[i % s->nvariables],
+                           (i < s->nvariables) ?
+                           s->step[i] : -s->step[i - s->nvariables]);
+    }
+
+#if DEBUG_SENSITIVITY
+  fprintf (stderr, "sensitivity_open_xml: end\n");
+#endif
+  return 1;
+
+exit_on_error:
+  sensitivity_free (s);
+#if DEBUG_SENSITIVITY
+  fprintf (stderr, "sensitivity_open_xml: end\n");
+#endif
+  return 0;
+}
+
+/**
+ * \fn static gpointer sensitivity_thread (SensitivityThread * data)
+ * \brief function to calculate the drops of all the sensitivity cases in a
+ *   thread. Every drop is calculated in all the cases with the same
+ *   pseudo-random numbers substream (common random numbers), so the
+ *   differences between cases are not masked by the sampling noise.
+ * \param data
+ * \brief SensitivityThread struct.
+ * \return NULL.
+ */
+static gpointer
+sensitivity_thread (SensitivityThread * data)
+{
+  gsl_rng *rng;
+  unsigned long long int t0;
+  unsigned int i, j;
+  if (trace_enabled)
+    t0 = trace_time ();
+  rng = gsl_rng_alloc (gsl_rng_taus);
+  for (i = data->first; i < data->last; ++i)
+    for (j = 0; j < data->ncases; ++j)
+      sprinkler_drop (data->sprinkler + j, data->air, data->trajectory, rng,
+                      i, NULL);
+  gsl_rng_free (rng);
+  if (trace_enabled)
+    {
+      trace_event ("worker", t0, trace_time ());
+      trace_flush ();
+    }
+  return NULL;
+}
+
+/**
+ * \fn void sensitivity_calculate (Sensitivity * s, Air * a, unsigned int n)
+ * \brief function to calculate the drops of all the sensitivity cases in
+ *   parallel threads.
+ * \param s
+ * \brief Sensitivity struct.
+ * \param a
+ * \brief Air struct.
+ * \param n
+ * \brief threads number.
+ */
+void
+sensitivity_calculate (Sensitivity * s, Air * a, unsigned int n)
+{
+  SensitivityThread *data;
+  GThread **thread;
+  unsigned int i, j, ntrajectories;
+#if DEBUG_SENSITIVITY
+  fprintf (stderr, "sensitivity_calculate: start\n");
+#endif
+  ntrajectories = s->sprinkler->ntrajectories;
+  if (!ntrajectories)
+    goto exit_calculate;
+  n = MAX (1, MIN (n, ntrajectories));
+  data = (SensitivityThread *) g_malloc (n * sizeof (SensitivityThread));
+  thread = (GThread **) g_malloc (n * sizeof (GThread *));
+  for (i = 0; i < n; ++i)
+    {
+      data[i].sprinkler
+        = (Sprinkler *) g_malloc (s->ncases * sizeof (Sprinkler));
+      for (j = 0; j < s->ncases; ++j)
+        sprinkler_copy (data[i].sprinkler + j, s->sprinkler + j);
+      memcpy (data[i].air, a, sizeof (Air));
+      data[i].ncases = s->ncases;
+      data[i].first = i * ntrajectories / n;
+      data[i].last = (i + 1) * ntrajectories / n;
+      thread[i]
+        = g_thread_new (NULL, (GThreadFunc) sensitivity_thread, data + i);
+    }
+  for (i = 0; i < n; ++i)
+    {
+      g_thread_join (thread[i]);
+      for (j = 0; j < s->ncases; ++j)
+        {
+          sprinkler_add (s->sprinkler + j, data[i].sprinkler + j);
+          sprinkler_free (data[i].sprinkler + j);
+        }
+      g_free (data[i].sprinkler);
+    }
+  g_free (thread);
+  g_free (data);
+
+exit_calculate:
+#if DEBUG_SENSITIVITY
+  fprintf (stderr, "sensitivity_calculate: end\n");
+#endif
+  return;
+}
+
+/**
+ * \fn static double sensitivity_output (Sprinkler * s, unsigned int i)
+ * \brief function to get a result of a sensitivity case: the mean drop
+ *   landing distance and, for every measurement point, the collected volume
+ *   and the drop hit frequency per emitted drop and the mean drop velocity.
+ *   The mean velocity is undefined on a measurement point without collected
+ *   drops.
+ * \param s
+ * \brief Sprinkler struct.
+ * \param i
+ * \brief result number.
+ * \return result value, NAN if undefined.
+ */
+static double
+sensitivity_output (Sprinkler * s, unsigned int i)
+{
+  Measurement *m;
+  if (!i)
+    return s->distance / s->ntrajectories;
+  m = s->measurement + (i - 1) / 3;
+  switch ((i - 1) % 3)
+    {
+    case 0:
+      return m->volume / s->ntrajectories;
+    case 1:
+      return m->weight / s->ntrajectories;
+    }
+  if (!m->nhits)
+    return NAN;
+  return m->velocity / m->weight;
+}
+
+/**
+ * \fn int sensitivity_write (Sensitivity * s, char *result)
+ * \brief function to write the results and their finite differences
+ *   derivatives respect to the perturbed parameters. The undefined results,
+ *   and the derivatives using them, are written as nan.
+ * \param s
+ * \brief Sensitivity struct.
+ * \param result
+ * \brief results file name.
+ * \return 1 on success, 0 on error.
+ */
+int
+sensitivity_write (Sensitivity * s, char *result)
+{
+  const char *name[3] = { "volume", "frequency", "velocity" };
+  FILE *file;
+  double y, yp, ym;
+  unsigned int i, j, n;
+#if DEBUG_SENSITIVITY
+  fprintf (stderr, "sensitivity_write: start\n");
+#endif
+  file = fopen (result, "w");
+  if (!file)
+    {
+      sensitivity_error (gettext ("unable to open the results file"));
+#if DEBUG_SENSITIVITY
+      fprintf (stderr, "sensitivity_write: end\n");
+#endif
+      return 0;
+    }
+  fprintf (file, "# result value");
+  for (j = 0; j < s->nvariables; ++j)
+    fprintf (file, " d/d%s",
+             (const char *) sensitivity_variable_name[s->variable[j]]);
+  fprintf (file, "\n");
+  n = 1 + 3 * s->sprinkler->nmeasurements;
+  for (i = 0; i < n; ++i)
+    {
+      if (!i)
+        fprintf (file, "distance");
+      else
+        fprintf (file, "%s-%u", name[(i - 1) % 3], (i - 1) / 3);
+      y = sensitivity_output (s->sprinkler, i);
+      fprintf (file, " %.14le", y);
+      for (j = 0; j < s->nvariables; ++j)
+        {
+          yp = sensitivity_output (s->sprinkler + 1 + j, i);
+          if (s->scheme == SENSITIVITY_SCHEME_CENTRAL)
+            {
+              ym = sensitivity_output (s->sprinkler + 1 + s->nvariables + j,
+                                       i);
+              fprintf (file, " %.14le", 0.5 * (yp - ym) / s->step[j]);
+            }
+          else
+            fprintf (file, " %.14le", (yp - y) / s->step[j]);
+        }
+      fprintf (file, "\n");
+    }
+  fclose (file);
+#if DEBUG_SENSITIVITY
+  fprintf (stderr, "sensitivity_write: end\n");
+#endif
+  return 1;
+}
+
+/**
+ * \fn int sensitivity_run_xml (Sensitivity * s, Air * a, xmlNode * node, \
+ *   char *result)
+ * \brief function to calculate the sensitivities on a XML node.
+ * \param s
+ * \brief Sensitivity struct.
+ * \param a
+ * \brief Air struct.
+ * \param node
+ * \brief XML node.
+ * \param result
+ * \brief results file name.
+ * \return 1 on success, 0 on error.
+ */
+int
+sensitivity_run_xml (Sensitivity * s, Air * a, xmlNode * node, char *result)
+{
+  int k;
+#if DEBUG_SENSITIVITY
+  fprintf (stderr, "sensitivity_run_xml: start\n");
+#endif
+  k = 0;
+  if (!sensitivity_open_xml (s, a, node))
+    goto exit_run;
+  sensitivity_calculate (s, a, nthreads);
+  k = sensitivity_write (s, result);
+  sensitivity_free (s);
+
+exit_run:
+#if DEBUG_SENSITIVITY
+  fprintf (stderr, "sensitivity_run_xml: end\n");
+#endif
+  return k;
+}
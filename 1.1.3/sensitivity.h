@@ -0,0 +1,103 @@
+/*
+Sprinkler: a software to calculate drop trajectories in sprinkler irrigation.
+
+AUTHORS: Javier Burguete.
+
+Copyright 2012-2015, AUTHORS.
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+	1. Redistributions of source code must retain the above copyright notice,
+		this list of conditions and the following disclaimer.
+
+	2. Redistributions in binary form must reproduce the above copyright notice,
+		this list of conditions and the following disclaimer in the
+		documentation and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY AUTHORS ``AS IS'' AND ANY EXPRESS OR IMPLIED
+WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+SHALL AUTHORS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+
+/**
+ * \file sensitivity.h
+ * \brief Header file to calculate the sensitivities of the sprinkler results
+ *   to the sprinkler parameters.
+ * \author Javier Burguete Tolosa.
+ * \copyright Copyright 2012-2015 Javier Burguete Tolosa, all rights reserved.
+ */
+#ifndef SENSITIVITY__H
+#define SENSITIVITY__H 1
+
+/**
+ * \enum SensitivityVariable
+ * \brief enum to define the perturbed sprinkler parameters.
+ */
+enum SensitivityVariable
+{
+  SENSITIVITY_VARIABLE_JET_TIME = 0,    ///< time of the emitted jet.
+  SENSITIVITY_VARIABLE_PRESSURE = 1,    ///< water pressure.
+  SENSITIVITY_VARIABLE_VERTICAL_ANGLE = 2,      ///< vertical angle.
+  SENSITIVITY_VARIABLE_MAXIMUM_DROP_DIAMETER = 3
+    ///< maximum drop diameter.
+};
+
+/**
+ * \enum SensitivityScheme
+ * \brief enum to define the finite differences schemes.
+ */
+enum SensitivityScheme
+{
+  SENSITIVITY_SCHEME_FORWARD = 0,       ///< forward differences.
+  SENSITIVITY_SCHEME_CENTRAL = 1        ///< central differences.
+};
+
+/**
+ * \struct Sensitivity
+ * \brief struct to define the sensitivity calculation.
+ */
+typedef struct
+{
+  Sprinkler *sprinkler;
+  ///< array of Sprinkler structs of the base and the perturbed cases.
+  double *step;                 ///< array of perturbation steps.
+  unsigned int *variable;       ///< array of perturbed parameter types.
+  unsigned int nvariables;      ///< number of perturbed parameters.
+  unsigned int ncases;          ///< number of simulated cases.
+  unsigned int scheme;          ///< finite differences scheme.
+} Sensitivity;
+
+/**
+ * \struct SensitivityThread
+ * \brief struct to define the data of a thread calculating the drops of all
+ *   the sensitivity cases.
+ */
+typedef struct
+{
+  Sprinkler *sprinkler;         ///< array of Sprinkler struct copies.
+  Air air[1];                   ///< Air struct copy.
+  Trajectory trajectory[1];     ///< Trajectory struct.
+  unsigned int ncases;          ///< number of simulated cases.
+  unsigned int first;           ///< first drop.
+  unsigned int last;            ///< last drop.
+} SensitivityThread;
+
+void sensitivity_error (char *message);
+void sensitivity_perturb (Sprinkler * s, unsigned int variable, double step);
+void sensitivity_free (Sensitivity * s);
+int sensitivity_open_xml (Sensitivity * s, Air * a, xmlNode * node);
+void sensitivity_calculate (Sensitivity * s, Air * a, unsigned int n);
+int sensitivity_write (Sensitivity * s, char *result);
+int sensitivity_run_xml (Sensitivity * s, Air * a, xmlNode * node,
+                         char *result);
+
+#endif
@@ -0,0 +1,567 @@
+/*
+Sprinkler: a software to calculate drop trajectories in sprinkler irrigation.
+
+AUTHORS: Javier Burguete.
+
+Copyright 2012-2015, AUTHORS.
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+	1. Redistributions of source code must retain the above copyright notice,
+		this list of conditions and the following disclaimer.
+
+	2. Redistributions in binary form must reproduce the above copyright notice,
+		this list of conditions and the following disclaimer in the
+		documentation and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY AUTHORS ``AS IS'' AND ANY EXPRESS OR IMPLIED
+WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+SHALL AUTHORS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+
+/**
+ * \file server.c
+ * \brief Source file to run a persistent simulation server. The server reads
+ *   requests from the standard input or from a local socket. Every request is
+ *   a line with the input file name and the results file name, and it is
+ *   answered, maybe out of order, by a line "ok results_name" or
+ *   "error results_name message". The parsed input files, and the opened
+ *   sprinklers, are kept between requests and they are parsed again only if
+ *   they are modified. The requests are run concurrently by a pool of worker
+ *   threads.
+ * \author Javier Burguete Tolosa.
+ * \copyright Copyright 2012-2015 Javier Burguete Tolosa, all rights reserved.
+ */
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <libxml/parser.h>
+#include <glib.h>
+#include <libintl.h>
+#include <gsl/gsl_rng.h>
+#include <gsl/gsl_vector.h>
+#ifdef G_OS_UNIX
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#endif
+#include "config.h"
+#include "utils.h"
+#include "trace.h"
+#include "air.h"
+#include "drop.h"
+#include "measurement.h"
+#include "trajectory.h"
+#include "sprinkler.h"
+#include "jet.h"
+#include "invert.h"
+#include "sensitivity.h"
+#include "objective.h"
+#include "calibrate.h"
+#include "batch.h"
+#include "layout.h"
+#include "sweep.h"
+#include "server.h"
+
+#define DEBUG_SERVER 0          ///< macro to debug server functions.
+
+#define SERVER_LINE 4096
+///< maximum length of a request line.
+
+/**
+ * \fn void server_error (char *message)
+ * \brief function to show an error message running the server.
+ * \param message
+ * \brief error message.
+ */
+void
+server_error (char *message)
+{
+  error_message = g_strconcat (gettext ("Server"), ": ", message, NULL);
+}
+
+/**
+ * \fn static void server_config_free (ServerConfig * c)
+ * \brief function to free the memory used by a ServerConfig struct.
+ * \param c
+ * \brief ServerConfig struct.
+ */
+static void
+server_config_free (ServerConfig * c)
+{
+  if (c->sprinkler)
+    {
+      sprinkler_free (c->sprinkler);
+      g_free (c->sprinkler);
+      g_free (c->air);
+    }
+  xmlFreeDoc (c->doc);
+  g_free (c->name);
+  g_free (c);
+}
+
+/**
+ * \fn ServerConfig *server_config_get (Server * s, char *name)
+ * \brief function to get a parsed input file, parsing it only if it is new or
+ *   it was modified after the last parsing. The Sprinkler and Air structs of
+ *   the sprinkler files are also opened once, so the measurement points and
+ *   the empirical drops distribution are read again only with the input file
+ *   modification time.
+ * \param s
+ * \brief Server struct.
+ * \param name
+ * \brief input file name.
+ * \return referenced ServerConfig struct on success, NULL on error.
+ */
+ServerConfig *
+server_config_get (Server * s, char *name)
+{
+  struct stat st;
+  ServerConfig *c;
+  xmlDoc *doc;
+  xmlNode *node;
+  Sprinkler *sprinkler;
+  Air *air;
+  unsigned int i;
+#if DEBUG_SERVER
+  fprintf (stderr, "server_config_get: start\n");
+#endif
+  c = NULL;
+  if (stat (name, &st))
+    {
+      server_error (gettext ("unable to open the input file"));
+      goto exit_on_error;
+    }
+  g_mutex_lock (&s->mutex);
+  for (i = 0; i < s->nconfigs; ++i)
+    if (!strcmp (s->config[i]->name, name))
+      break;
+  if (i < s->nconfigs && s->config[i]->mtime == st.st_mtime)
+    {
+      c = s->config[i];
+      ++c->nreferences;
+      goto exit_on_success;
+    }
+  doc = xmlReadFile (name, NULL, XML_PARSE_NOBLANKS);
+  if (!doc || !xmlDocGetRootElement (doc))
+    {
+      xmlFreeDoc (doc);
+      server_error (gettext ("unable to parse the input file"));
+      goto exit_on_success;
+    }
+  sprinkler = NULL;
+  air = NULL;
+  node = xmlDocGetRootElement (doc);
+  if (!xmlStrcmp (node->name, XML_SPRINKLER))
+    {
+      sprinkler = (Sprinkler *) g_malloc (sizeof (Sprinkler));
+      air = (Air *) g_malloc (sizeof (Air));
+      if (!sprinkler_open_xml (sprinkler, air, node))
+        {
+          sprinkler_free (sprinkler);
+          g_free (sprinkler);
+          g_free (air);
+          xmlFreeDoc (doc);
+          goto exit_on_success;
+        }
+    }
+  c = (ServerConfig *) g_malloc (sizeof (ServerConfig));
+  c->name = g_strdup (name);
+  c->doc = doc;
+  c->sprinkler = sprinkler;
+  c->air = air;
+  c->mtime = st.st_mtime;
+  c->nreferences = 2;
+  if (i < s->nconfigs)
+    {
+      if (!--s->config[i]->nreferences)
+        server_config_free (s->config[i]);
+    }
+  else
+    s->config = (ServerConfig **)
+      g_realloc (s->config, ++s->nconfigs * sizeof (ServerConfig *));
+  s->config[i] = c;
+
+exit_on_success:
+  g_mutex_unlock (&s->mutex);
+
+exit_on_error:
+#if DEBUG_SERVER
+  fprintf (stderr, "server_config_get: end\n");
+#endif
+  return c;
+}
+
+/**
+ * \fn void server_config_unref (Server * s, ServerConfig * c)
+ * \brief function to release a reference of a parsed input file.
+ * \param s
+ * \brief Server struct.
+ * \param c
+ * \brief ServerConfig struct.
+ */
+void
+server_config_unref (Server * s, ServerConfig * c)
+{
+  g_mutex_lock (&s->mutex);
+  if (!--c->nreferences)
+    server_config_free (c);
+  g_mutex_unlock (&s->mutex);
+}
+
+/**
+ * \fn ServerClient *server_client_new (FILE * file)
+ * \brief function to create a client.
+ * \param file
+ * \brief responses file.
+ * \return ServerClient struct.
+ */
+ServerClient *
+server_client_new (FILE * file)
+{
+  ServerClient *c;
+  c = (ServerClient *) g_malloc (sizeof (ServerClient));
+  c->file = file;
+  g_mutex_init (&c->mutex);
+  c->nreferences = 1;
+  return c;
+}
+
+/**
+ * \fn void server_client_unref (ServerClient * c)
+ * \brief function to release a reference of a client, closing its responses
+ *   file when all its requests are answered.
+ * \param c
+ * \brief ServerClient struct.
+ */
+void
+server_client_unref (ServerClient * c)
+{
+  unsigned int n;
+  g_mutex_lock (&c->mutex);
+  n = --c->nreferences;
+  g_mutex_unlock (&c->mutex);
+  if (n)
+    return;
+  fclose (c->file);
+  g_mutex_clear (&c->mutex);
+  g_free (c);
+}
+
+/**
+ * \fn void server_respond (ServerClient * c, char *result, char *message)
+ * \brief function to answer a request.
+ * \param c
+ * \brief ServerClient struct.
+ * \param result
+ * \brief results file name.
+ * \param message
+ * \brief error message or NULL on success.
+ */
+void
+server_respond (ServerClient * c, char *result, char *message)
+{
+  g_mutex_lock (&c->mutex);
+  if (message)
+    fprintf (c->file, "error %s %s\n", result, message);
+  else
+    fprintf (c->file, "ok %s\n", result);
+  fflush (c->file);
+  g_mutex_unlock (&c->mutex);
+}
+
+/**
+ * \fn int server_run_node (ServerConfig * c, char *result)
+ * \brief function to run the simulation defined by a parsed input file. The
+ *   sprinklers run on copies of their opened Sprinkler and Air structs.
+ * \param c
+ * \brief ServerConfig struct.
+ * \param result
+ * \brief results file name.
+ * \return 1 on success, 0 on error.
+ */
+int
+server_run_node (ServerConfig * c, char *result)
+{
+  Sprinkler sprinkler[1];
+  Sensitivity sensitivity[1];
+  Calibrate calibrate[1];
+  Batch batch[1];
+  Layout layout[1];
+  Sweep sweep[1];
+  Jet jet[1];
+  Trajectory trajectory[1];
+  Air air[1];
+  xmlNode *node;
+  node = xmlDocGetRootElement (c->doc);
+  if (c->sprinkler)
+    {
+      sprinkler_copy (sprinkler, c->sprinkler);
+      memcpy (air, c->air, sizeof (Air));
+      return sprinkler_run (sprinkler, air, trajectory, node, result);
+    }
+  if (!xmlStrcmp (node->name, XML_TRAJECTORY))
+    return trajectory_run_xml (trajectory, air, node, result);
+  if (!xmlStrcmp (node->name, XML_INVERT))
+    return invert_run_xml (node, air, trajectory, jet, result);
+  if (!xmlStrcmp (node->name, XML_BATCH))
+    return batch_run_xml (batch, air, node, result);
+  if (!xmlStrcmp (node->name, XML_LAYOUT))
+    return layout_run_xml (layout, node, result);
+  if (!xmlStrcmp (node->name, XML_SWEEP))
+    return sweep_run_xml (sweep, node, result);
+  if (!xmlStrcmp (node->name, XML_CALIBRATE))
+    return calibrate_run_xml (calibrate, node, result);
+  if (!xmlStrcmp (node->name, XML_SENSITIVITY))
+    return sensitivity_run_xml (sensitivity, air, node, result);
+  error_message = g_strconcat (gettext ("Input file"), ": ",
+                               gettext ("Bad node"), NULL);
+  return 0;
+}
+
+/**
+ * \fn void server_request (ServerRequest * r, Server * s)
+ * \brief function to run a request in a worker thread.
+ * \param r
+ * \brief ServerRequest struct.
+ * \param s
+ * \brief Server struct.
+ */
+void
+server_request (ServerRequest * r, Server * s)
+{
+  ServerConfig *c;
+  int k;
+#if DEBUG_SERVER
+  fprintf (stderr, "server_request: start\n");
+#endif
+  g_free (error_message);
+  error_message = NULL;
+  c = server_config_get (s, r->input);
+  k = 0;
+  if (c)
+    {
+      k = server_run_node (c, r->result);
+      server_config_unref (s, c);
+    }
+  if (k)
+    server_respond (r->client, r->result, NULL);
+  else
+    {
+      if (!error_message)
+        error_message = g_strdup (gettext ("Bad input file"));
+      g_strdelimit (error_message, "\r\n", ' ');
+      server_respond (r->client, r->result, error_message);
+    }
+  g_free (error_message);
+  error_message = NULL;
+  if (trace_enabled)
+    trace_flush ();
+  server_client_unref (r->client);
+  g_free (r->result);
+  g_free (r->input);
+  g_free (r);
+#if DEBUG_SERVER
+  fprintf (stderr, "server_request: end\n");
+#endif
+}
+
+/**
+ * \fn void server_read (Server * s, ServerClient * c, FILE * file)
+ * \brief function to read the requests of a client until the end of file and
+ *   to send them to the worker threads.
+ * \param s
+ * \brief Server struct.
+ * \param c
+ * \brief ServerClient struct.
+ * \param file
+ * \brief requests file.
+ */
+void
+server_read (Server * s, ServerClient * c, FILE * file)
+{
+  char buffer[SERVER_LINE], input[SERVER_LINE], result[SERVER_LINE];
+  ServerRequest *r;
+  int n;
+#if DEBUG_SERVER
+  fprintf (stderr, "server_read: start\n");
+#endif
+  while (fgets (buffer, SERVER_LINE, file))
+    {
+      n = sscanf (buffer, "%s%s", input, result);
+      if (n <= 0)
+        continue;
+      if (n == 1)
+        {
+          server_respond (c, input, gettext ("bad request"));
+          continue;
+        }
+      r = (ServerRequest *) g_malloc (sizeof (ServerRequest));
+      r->client = c;
+      r->input = g_strdup (input);
+      r->result = g_strdup (result);
+      g_mutex_lock (&c->mutex);
+      ++c->nreferences;
+      g_mutex_unlock (&c->mutex);
+      g_thread_pool_push (s->pool, r, NULL);
+    }
+#if DEBUG_SERVER
+  fprintf (stderr, "server_read: end\n");
+#endif
+}
+
+#ifdef G_OS_UNIX
+
+/**
+ * \fn static gpointer server_connection (ServerConnection * sc)
+ * \brief function to read the requests of a socket connection in a thread.
+ * \param sc
+ * \brief ServerConnection struct.
+ * \return NULL.
+ */
+static gpointer
+server_connection (ServerConnection * sc)
+{
+  ServerClient *c;
+  FILE *file, *file2;
+  file = fdopen (sc->fd, "r");
+  file2 = fdopen (dup (sc->fd), "w");
+  if (!file || !file2)
+    {
+      if (file)
+        fclose (file);
+      else
+        close (sc->fd);
+      if (file2)
+        fclose (file2);
+      g_free (sc);
+      return NULL;
+    }
+  c = server_client_new (file2);
+  server_read (sc->server, c, file);
+  fclose (file);
+  server_client_unref (c);
+  g_free (sc);
+  return NULL;
+}
+
+#endif
+
+/**
+ * \fn int server_run (char *socket_name)
+ * \brief function to run the server. The global number of threads is used as
+ *   the number of worker threads and every request is run by one thread.
+ * \param socket_name
+ * \brief local socket name or NULL to read the requests from the standard
+ *   input.
+ * \return 1 on success, 0 on error.
+ */
+int
+server_run (char *socket_name)
+{
+  Server s[1];
+  ServerClient *c;
+  FILE *file;
+  unsigned int i;
+  int fd;
+#ifdef G_OS_UNIX
+  struct sockaddr_un address;
+  ServerConnection *sc;
+  int fd2;
+#endif
+#if DEBUG_SERVER
+  fprintf (stderr, "server_run: start\n");
+#endif
+  xmlInitParser ();
+  s->config = NULL;
+  s->nconfigs = 0;
+  g_mutex_init (&s->mutex);
+  s->pool = g_thread_pool_new ((GFunc) server_request, s, MAX (1, nthreads),
+                               TRUE, NULL);
+  nthreads = 1;
+  if (!socket_name)
+    {
+      // responses go to the original standard output, while the messages
+      // printed by the simulations are redirected to the standard error
+      fd = dup (STDOUT_FILENO);
+      file = fdopen (fd, "w");
+      if (!file)
+        {
+          server_error (gettext ("unable to open the responses file"));
+          goto exit_on_error;
+        }
+      dup2 (STDERR_FILENO, STDOUT_FILENO);
+      c = server_client_new (file);
+      server_read (s, c, stdin);
+      g_thread_pool_free (s->pool, FALSE, TRUE);
+      server_client_unref (c);
+      for (i = 0; i < s->nconfigs; ++i)
+        server_config_free (s->config[i]);
+      g_free (s->config);
+      g_mutex_clear (&s->mutex);
+#if DEBUG_SERVER
+      fprintf (stderr, "server_run: end\n");
+#endif
+      return 1;
+    }
+#ifdef G_OS_UNIX
+  signal (SIGPIPE, SIG_IGN);
+  if (strlen (socket_name) >= sizeof (address.sun_path))
+    {
+      server_error (gettext ("socket name too long"));
+      goto exit_on_error;
+    }
+  fd = socket (AF_UNIX, SOCK_STREAM, 0);
+  if (fd < 0)
+    {
+      server_error (gettext ("unable to open the socket"));
+      goto exit_on_error;
+    }
+  memset (&address, 0, sizeof (address));
+  address.sun_family = AF_UNIX;
+  strcpy (address.sun_path, socket_name);
+  unlink (socket_name);
+  if (bind (fd, (struct sockaddr *) &address, sizeof (address))
+      || listen (fd, SOMAXCONN))
+    {
+      close (fd);
+      server_error (gettext ("unable to listen on the socket"));
+      goto exit_on_error;
+    }
+  for (;;)
+    {
+      fd2 = accept (fd, NULL, NULL);
+      if (fd2 < 0)
+        continue;
+      sc = (ServerConnection *) g_malloc (sizeof (ServerConnection));
+      sc->server = s;
+      sc->fd = fd2;
+      g_thread_unref (g_thread_new (NULL, (GThreadFunc) server_connection,
+                                    sc));
+    }
+#else
+  server_error (gettext ("local sockets are not supported"));
+#endif
+
+exit_on_error:
+  g_thread_pool_free (s->pool, FALSE, TRUE);
+  g_mutex_clear (&s->mutex);
+#if DEBUG_SERVER
+  fprintf (stderr, "server_run: end\n");
+#endif
+  return 0;
+}
@@ -0,0 +1,110 @@
+/*
+Sprinkler: a software to calculate drop trajectories in sprinkler irrigation.
+
+AUTHORS: Javier Burguete.
+
+Copyright 2012-2015, AUTHORS.
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+	1. Redistributions of source code must retain the above copyright notice,
+		this list of conditions and the following disclaimer.
+
+	2. Redistributions in binary form must reproduce the above copyright notice,
+		this list of conditions and the following disclaimer in the
+		documentation and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY AUTHORS ``AS IS'' AND ANY EXPRESS OR IMPLIED
+WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+SHALL AUTHORS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+
+/**
+ * \file server.h
+ * \brief Header file to run a persistent simulation server.
+ * \author Javier Burguete Tolosa.
+ * \copyright Copyright 2012-2015 Javier Burguete Tolosa, all rights reserved.
+ */
+#ifndef SERVER__H
+#define SERVER__H 1
+
+/**
+ * \struct ServerConfig
+ * \brief struct to define a parsed input file kept between requests.
+ */
+typedef struct
+{
+  char *name;                   ///< input file name.
+  xmlDoc *doc;                  ///< parsed XML document.
+  Sprinkler *sprinkler;
+  ///< opened Sprinkler struct (NULL if the root is not a sprinkler).
+  Air *air;                     ///< opened Air struct of the sprinkler.
+  time_t mtime;                 ///< modification time of the parsed file.
+  unsigned int nreferences;     ///< number of references.
+} ServerConfig;
+
+/**
+ * \struct ServerClient
+ * \brief struct to define a client sending requests.
+ */
+typedef struct
+{
+  FILE *file;                   ///< responses file.
+  GMutex mutex;                 ///< mutex to write the responses.
+  unsigned int nreferences;     ///< number of references.
+} ServerClient;
+
+/**
+ * \struct ServerRequest
+ * \brief struct to define a simulation request.
+ */
+typedef struct
+{
+  ServerClient *client;         ///< client sending the request.
+  char *input;                  ///< input file name.
+  char *result;                 ///< results file name.
+} ServerRequest;
+
+/**
+ * \struct Server
+ * \brief struct to define the persistent simulation server.
+ */
+typedef struct
+{
+  ServerConfig **config;        ///< array of parsed input files.
+  GThreadPool *pool;            ///< pool of worker threads.
+  GMutex mutex;                 ///< mutex to access the parsed input files.
+  unsigned int nconfigs;        ///< number of parsed input files.
+} Server;
+
+/**
+ * \struct ServerConnection
+ * \brief struct to define the data of a thread reading a socket connection.
+ */
+typedef struct
+{
+  Server *server;               ///< Server struct.
+  int fd;                       ///< socket file descriptor.
+} ServerConnection;
+
+void server_error (char *message);
+ServerConfig *server_config_get (Server * s, char *name);
+void server_config_unref (Server * s, ServerConfig * c);
+ServerClient *server_client_new (FILE * file);
+void server_client_unref (ServerClient * c);
+void server_respond (ServerClient * c, char *result, char *message);
+int server_run_node (ServerConfig * c, char *result);
+void server_request (ServerRequest * r, Server * s);
+void server_read (Server * s, ServerClient * c, FILE * file);
+int server_run (char *socket_name);
+
+#endif
@@ -35,99 +35,1243 @@ OF SUCH DAMAGE.
  */
 #define _GNU_SOURCE
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <math.h>
+#include <unistd.h>
 #include <libxml/parser.h>
 #include <glib.h>
+#include <glib/gstdio.h>
 #include <libintl.h>
 #include <gsl/gsl_rng.h>
+#include <gsl/gsl_cdf.h>
+#if HAVE_MPI
+#include <mpi.h>
+#endif
 #if HAVE_GTK
 #include <gtk/gtk.h>
 #endif
-#include "config.h"
-#include "utils.h"
-#include "air.h"
-#include "drop.h"
-#include "measurement.h"
-#include "trajectory.h"
-#include "sprinkler.h"
+#include "config.h"
+#include "utils.h"
+#include "trace.h"
+#include "air.h"
+#include "drop.h"
+#include "measurement.h"
+#include "trajectory.h"
+#include "sprinkler.h"
+
+#define DEBUG_SPRINKLER 0       ///< macro to debug sprinkler functions.
+
+char *checkpoint_name = NULL;
+///< checkpoint file name (NULL without checkpoints, only on sprinkler files).
+unsigned int checkpoint_drops = 0;
+///< number of calculated drops between checkpoints.
+unsigned int checkpoint_resume = 0;
+///< 1 to resume the run from the checkpoint file, 0 otherwise.
+int mpi_rank = 0;               ///< rank of the MPI process (0 without MPI).
+int mpi_size = 1;               ///< number of MPI processes (1 without MPI).
+
+/**
+ * \fn void trajectory_init_with_sprinkler (Trajectory *t, Sprinkler *s)
+ * \brief function to init drop trajectory variables from sprinkler data.
+ * \param t
+ * \brief Trajectory struct.
+ * \param s
+ * \brief Sprinkler struct.
+ */
+void
+trajectory_init_with_sprinkler (Trajectory * t, Sprinkler * s)
+{
+  Drop *d;
+  double v, k2, k3;
+#if DEBUG_SPRINKLER
+  fprintf (stderr, "trajectory_init_with_sprinkler: start\n");
+#endif
+  d = t->drop;
+  t->t = 0.;
+  t->cfl = s->cfl;
+  t->dt = s->dt;
+  t->bed_level = s->bed_level;
+  t->drop_maximum_diameter = s->drop_dmax;
+  d->r[0] = s->x;
+  d->r[1] = s->y;
+  d->r[2] = s->z;
+  v = sqrt (2. * s->pressure / d->density);
+  k2 = s->horizontal_angle * M_PI / 180.;
+  k3 = s->vertical_angle * M_PI / 180.;
+  d->v[0] = v * cos (k3) * cos (k2);
+  d->v[1] = v * cos (k3) * sin (k2);
+  d->v[2] = v * sin (k3);
+#if DEBUG_SPRINKLER
+  fprintf (stderr, "trajectory_init_with_sprinkler: Time step size=%le\n",
+           t->dt);
+  fprintf (stderr, "trajectory_init_with_sprinkler: Water pressure=%le "
+           "Drop density=%le\n", s->pressure, d->density);
+  fprintf (stderr, "trajectory_init_with_sprinkler: "
+           "Drop velocity=(%le,%le,%le)\n", d->v[0], d->v[1], d->v[2]);
+  fprintf (stderr, "trajectory_init_with_sprinkler: Jet time=%lg\n",
+           t->jet_time);
+  fprintf (stderr, "trajectory_init_with_sprinkler: end\n");
+#endif
+}
+
+/**
+ * \fn double sprinkler_diameter (Sprinkler * s, unsigned int i, double u, \
+ *   double *weight)
+ * \brief function to sample the diameter of the i-th sprinkler drop. The
+ *   stratified and volume samplings divide the pseudo-random numbers in as many
+ *   classes of equal probability as drops, or as drops of a batch on
+ *   convergence runs (the Sobol points are already stratified). With the
+ *   volume sampling a fraction VOLUME_SAMPLING_UNIFORM of the classes draws
+ *   the diameters uniformly and the rest with a density proportional to the
+ *   drop volume, so the big drops carrying most of the water are sampled more
+ *   while the small drops feeding the near collectors are not starved. The
+ *   statistical weight of every drop, the uniform density divided by the
+ *   mixture density, corrects the distribution of the diameters. The
+ *   empirical sampling draws the diameters of the measured distribution with
+ *   its alias table in a constant time, so no statistical weights are
+ *   required.
+ * \param s
+ * \brief Sprinkler struct.
+ * \param i
+ * \brief drop number.
+ * \param u
+ * \brief uniform random number in [0,1).
+ * \param weight
+ * \brief pointer to the drop statistical weight.
+ * \return drop diameter.
+ */
+double
+sprinkler_diameter (Sprinkler * s, unsigned int i, double u, double *weight)
+{
+  double diameter, dmin4, dmax4;
+  unsigned int n;
+  if (s->diameter_sampling == SPRINKLER_DIAMETER_SAMPLING_UNIFORM)
+    {
+      *weight = 1.;
+      return s->drop_dmin + (s->drop_dmax - s->drop_dmin) * u;
+    }
+  if (s->sampling == SPRINKLER_SAMPLING_RANDOM)
+    {
+      n = s->batch ? s->batch : s->ntrajectories;
+      u = (i % n + u) / n;
+    }
+  if (s->diameter_sampling == SPRINKLER_DIAMETER_SAMPLING_STRATIFIED)
+    {
+      *weight = 1.;
+      return s->drop_dmin + (s->drop_dmax - s->drop_dmin) * u;
+    }
+  if (s->diameter_sampling == SPRINKLER_DIAMETER_SAMPLING_EMPIRICAL)
+    {
+      *weight = 1.;
+      return s->distribution[alias_sample (s->distribution_probability,
+                                           s->distribution_alias,
+                                           s->ndistribution, u)];
+    }
+  dmin4 = s->drop_dmin * s->drop_dmin * s->drop_dmin * s->drop_dmin;
+  dmax4 = s->drop_dmax * s->drop_dmax * s->drop_dmax * s->drop_dmax;
+  if (u < VOLUME_SAMPLING_UNIFORM)
+    diameter = s->drop_dmin + (s->drop_dmax - s->drop_dmin) * u
+      / VOLUME_SAMPLING_UNIFORM;
+  else
+    diameter = pow (dmin4 + (u - VOLUME_SAMPLING_UNIFORM)
+                    / (1. - VOLUME_SAMPLING_UNIFORM) * (dmax4 - dmin4), 0.25);
+  *weight = 1. / (VOLUME_SAMPLING_UNIFORM + (1. - VOLUME_SAMPLING_UNIFORM) * 4.
+                  * diameter * diameter * diameter
+                  * (s->drop_dmax - s->drop_dmin) / (dmax4 - dmin4));
+  return diameter;
+}
+
+/**
+ * \fn void trajectory_open_with_sprinkler (Trajectory *t, Sprinkler *s, \
+ *   Air * a, gsl_rng * rng, unsigned int i)
+ * \brief function to init drop trajectory variables from sprinkler data.
+ * \param t
+ * \brief Trajectory struct.
+ * \param s
+ * \brief Sprinkler struct.
+ * \param a
+ * \brief Air struct.
+ * \param rng
+ * \brief GSL pseudo-random numbers generator struct.
+ * \param i
+ * \brief drop number.
+ */
+void
+trajectory_open_with_sprinkler (Trajectory * t, Sprinkler * s, Air * a,
+                                gsl_rng * rng, unsigned int i)
+{
+  double diameter, weight;
+#if DEBUG_SPRINKLER
+  fprintf (stderr, "trajectory_open_with_sprinkler: start\n");
+#endif
+  diameter = sprinkler_diameter (s, i, gsl_rng_uniform (rng), &weight);
+  s->horizontal_angle
+    = s->angle_min + (s->angle_max - s->angle_min) * gsl_rng_uniform (rng);
+  trajectory_open_data (t, a, rng, diameter, s->jet_model, s->detach_model,
+                        s->drag_model, s->drop_dmax, s->drag_coefficient);
+  t->drop->weight = weight;
+#if DEBUG_SPRINKLER
+  fprintf (stderr, "trajectory_open_with_sprinkler: end\n");
+#endif
+}
+
+/**
+ * \fn void sprinkler_copy (Sprinkler * s, Sprinkler * s0)
+ * \brief function to copy a Sprinkler struct with its own measurement points,
+ *   its own empirical drops distribution and without collected or landed
+ *   drops.
+ * \param s
+ * \brief Sprinkler struct copy.
+ * \param s0
+ * \brief Sprinkler struct to copy.
+ */
+void
+sprinkler_copy (Sprinkler * s, Sprinkler * s0)
+{
+  unsigned int i;
+  memcpy (s, s0, sizeof (Sprinkler));
+  s->distance = 0.;
+  s->measurement = g_malloc (s->nmeasurements * sizeof (Measurement));
+  memcpy (s->measurement, s0->measurement,
+          s->nmeasurements * sizeof (Measurement));
+  for (i = 0; i < s->nmeasurements; ++i)
+    measurement_init (s->measurement + i);
+  s->volume = 0.;
+  if (s->nrings)
+    s->profile = g_malloc0 (s->nrings * sizeof (double));
+  if (!s->ndistribution)
+    return;
+  s->distribution = g_malloc (s->ndistribution * sizeof (double));
+  memcpy (s->distribution, s0->distribution,
+          s->ndistribution * sizeof (double));
+  s->distribution_probability = g_malloc (s->ndistribution * sizeof (double));
+  memcpy (s->distribution_probability, s0->distribution_probability,
+          s->ndistribution * sizeof (double));
+  s->distribution_alias = g_malloc (s->ndistribution * sizeof (unsigned int));
+  memcpy (s->distribution_alias, s0->distribution_alias,
+          s->ndistribution * sizeof (unsigned int));
+}
+
+/**
+ * \fn void sprinkler_add (Sprinkler * s, Sprinkler * s2)
+ * \brief function to add the drops collected or landed on a Sprinkler struct
+ *   copy.
+ * \param s
+ * \brief Sprinkler struct.
+ * \param s2
+ * \brief Sprinkler struct copy to add.
+ */
+void
+sprinkler_add (Sprinkler * s, Sprinkler * s2)
+{
+  unsigned int i;
+  s->distance += s2->distance;
+  for (i = 0; i < s->nmeasurements; ++i)
+    measurement_add (s->measurement + i, s2->measurement + i);
+  s->volume += s2->volume;
+  for (i = 0; i < s->nrings; ++i)
+    s->profile[i] += s2->profile[i];
+}
+
+/**
+ * \fn void sprinkler_free (Sprinkler * s)
+ * \brief function to free the memory used by a Sprinkler struct.
+ * \param s
+ * \brief Sprinkler struct.
+ */
+void
+sprinkler_free (Sprinkler * s)
+{
+  g_free (s->measurement);
+  s->measurement = NULL;
+  s->nmeasurements = 0;
+  g_free (s->distribution);
+  g_free (s->distribution_probability);
+  g_free (s->distribution_alias);
+  s->distribution = s->distribution_probability = NULL;
+  s->distribution_alias = NULL;
+  s->ndistribution = 0;
+  g_free (s->profile);
+  s->profile = NULL;
+  s->nrings = 0;
+}
+
+/**
+ * \fn static void sprinkler_clear (Sprinkler * s)
+ * \brief function to clear the drops collected or landed on a Sprinkler
+ *   struct.
+ * \param s
+ * \brief Sprinkler struct.
+ */
+static void
+sprinkler_clear (Sprinkler * s)
+{
+  unsigned int i;
+  s->distance = s->volume = 0.;
+  for (i = 0; i < s->nmeasurements; ++i)
+    measurement_init (s->measurement + i);
+  for (i = 0; i < s->nrings; ++i)
+    s->profile[i] = 0.;
+}
+
+/**
+ * \fn static unsigned int sprinkler_size (Sprinkler * s)
+ * \brief function to get the size of the packed drops data of a Sprinkler
+ *   struct.
+ * \param s
+ * \brief Sprinkler struct.
+ * \return number of doubles of the packed drops data.
+ */
+static unsigned int
+sprinkler_size (Sprinkler * s)
+{
+  return 2 + 7 * s->nmeasurements + s->nrings;
+}
+
+/**
+ * \fn static void sprinkler_pack (Sprinkler * s, double *x)
+ * \brief function to pack the drops collected or landed on a Sprinkler struct
+ *   in an array of doubles. The numbers of hits are exactly packed as doubles.
+ * \param s
+ * \brief Sprinkler struct.
+ * \param x
+ * \brief array of packed drops data.
+ */
+static void
+sprinkler_pack (Sprinkler * s, double *x)
+{
+  Measurement *m;
+  unsigned int i;
+  *(x++) = s->distance;
+  *(x++) = s->volume;
+  for (i = 0; i < s->nmeasurements; ++i)
+    {
+      m = s->measurement + i;
+      *(x++) = m->volume;
+      *(x++) = m->velocity;
+      *(x++) = m->weight;
+      *(x++) = m->weight2;
+      *(x++) = m->velocity_weight2;
+      *(x++) = m->velocity2;
+      *(x++) = (double) m->nhits;
+    }
+  memcpy (x, s->profile, s->nrings * sizeof (double));
+}
+
+/**
+ * \fn static void sprinkler_unpack (Sprinkler * s, double *x)
+ * \brief function to set the drops collected or landed on a Sprinkler struct
+ *   from an array of packed drops data.
+ * \param s
+ * \brief Sprinkler struct.
+ * \param x
+ * \brief array of packed drops data.
+ */
+static void
+sprinkler_unpack (Sprinkler * s, double *x)
+{
+  Measurement *m;
+  unsigned int i;
+  s->distance = *(x++);
+  s->volume = *(x++);
+  for (i = 0; i < s->nmeasurements; ++i)
+    {
+      m = s->measurement + i;
+      m->volume = *(x++);
+      m->velocity = *(x++);
+      m->weight = *(x++);
+      m->weight2 = *(x++);
+      m->velocity_weight2 = *(x++);
+      m->velocity2 = *(x++);
+      m->nhits = (unsigned long int) *(x++);
+    }
+  memcpy (s->profile, x, s->nrings * sizeof (double));
+}
+
+/**
+ * \fn void sprinkler_drop (Sprinkler * s, Air * a, Trajectory * t, \
+ *   gsl_rng * rng, unsigned int i, FILE * file)
+ * \brief function to calculate the trajectory of the i-th sprinkler drop with
+ *   its own pseudo-random numbers substream.
+ * \param s
+ * \brief Sprinkler struct.
+ * \param a
+ * \brief Air struct.
+ * \param t
+ * \brief Trajectory struct.
+ * \param rng
+ * \brief GSL pseudo-random numbers generator struct.
+ * \param i
+ * \brief drop number.
+ * \param file
+ * \brief measurements file.
+ */
+void
+sprinkler_drop (Sprinkler * s, Air * a, Trajectory * t, gsl_rng * rng,
+                unsigned int i, FILE * file)
+{
+  Drop *d;
+  double u[RANDOM_SOBOL_DIMENSIONS], diameter, weight, r, volume;
+  unsigned int k;
+#if DEBUG_SPRINKLER
+  fprintf (stderr, "sprinkler_drop: start\n");
+  fprintf (stderr, "sprinkler_drop: trajectory=%u\n", i);
+#endif
+  gsl_rng_set (rng, random_seed (RANDOM_SEED, i));
+  if (s->sampling == SPRINKLER_SAMPLING_SOBOL)
+    {
+      // diameter, horizontal angle, detach fraction, wind angle and wind
+      // uncertainty from the i-th quasi-random point
+      random_sobol (RANDOM_SEED, i, u);
+      diameter = sprinkler_diameter (s, i, u[0], &weight);
+      s->horizontal_angle = s->angle_min + (s->angle_max - s->angle_min) * u[1];
+      trajectory_open_data (t, a, rng, diameter, s->jet_model,
+                            DROP_DETACH_MODEL_TOTAL, s->drag_model,
+                            s->drop_dmax, s->drag_coefficient);
+      t->drop->weight = weight;
+      t->jet_time = s->jet_time;
+      trajectory_init (t, a, rng);
+      if (s->detach_model == DROP_DETACH_MODEL_RANDOM)
+        t->drop->jet_time *= u[2];
+      trajectory_init_with_sprinkler (t, s);
+      air_wind_sample (a, 2. * M_PI * u[3],
+                       gsl_cdf_ugaussian_Pinv (0.5 + 0.5 * u[4]));
+    }
+  else
+    {
+      trajectory_open_with_sprinkler (t, s, a, rng, i);
+      t->jet_time = s->jet_time;
+      trajectory_init (t, a, rng);
+      trajectory_init_with_sprinkler (t, s);
+      air_wind_uncertainty (a, rng);
+    }
+  trajectory_calculate (t, a, s->measurement, s->nmeasurements, file);
+  d = t->drop;
+  r = sqrt ((d->r[0] - s->x) * (d->r[0] - s->x)
+            + (d->r[1] - s->y) * (d->r[1] - s->y));
+  s->distance += r;
+  if (s->nrings)
+    {
+      volume = d->weight * M_PI / 6. * d->diameter * d->diameter * d->diameter;
+      s->volume += volume;
+      k = (unsigned int) (r * s->nrings / s->radius);
+      if (k < s->nrings)
+        s->profile[k] += volume;
+    }
+#if DEBUG_SPRINKLER
+  fprintf (stderr, "sprinkler_drop: end\n");
+#endif
+}
+
+/**
+ * \fn static int sprinkler_steal (SprinklerThread * data)
+ * \brief function to steal the back half of the drops pending on other thread,
+ *   searching from the next thread.
+ * \param data
+ * \brief SprinklerThread struct.
+ * \return 1 on success, 0 if no thread has pending drops.
+ */
+static int
+sprinkler_steal (SprinklerThread * data)
+{
+  SprinklerDeque *victim, *deque;
+  unsigned int i, first, last;
+  deque = data->deque + data->thread;
+  for (i = 1; i < data->nthreads; ++i)
+    {
+      victim = data->deque + (data->thread + i) % data->nthreads;
+      g_mutex_lock (&victim->mutex);
+      last = victim->last;
+      first = last - (last - victim->first + 1) / 2;
+      victim->last = first;
+      g_mutex_unlock (&victim->mutex);
+      if (first < last)
+        {
+          g_mutex_lock (&deque->mutex);
+          deque->first = first;
+          deque->last = last;
+          g_mutex_unlock (&deque->mutex);
+          ++data->load->steals;
+          return 1;
+        }
+    }
+  return 0;
+}
+
+/**
+ * \fn static gpointer sprinkler_thread (SprinklerThread * data)
+ * \brief function to calculate the sprinkler drops of a thread. The thread
+ *   takes chunks of a fraction of its pending blocks of drops, so the chunks
+ *   are large at the beginning and small at the end, and steals the back half
+ *   of the blocks pending on other thread when it has no more blocks. The
+ *   drops data of every block are packed on their own place and the position
+ *   of every chunk on the temporary measurements file is saved.
+ * \param data
+ * \brief SprinklerThread struct.
+ * \return NULL.
+ */
+static gpointer
+sprinkler_thread (SprinklerThread * data)
+{
+  SprinklerDeque *deque;
+  SprinklerChunk *chunk;
+  gsl_rng *rng;
+  gint64 busy;
+  unsigned long long int t0;
+  unsigned int i, j, first, last, begin, end;
+  if (trace_enabled)
+    t0 = trace_time ();
+  busy = g_get_monotonic_time ();
+  rng = gsl_rng_alloc (gsl_rng_taus);
+  deque = data->deque + data->thread;
+  for (;;)
+    {
+      g_mutex_lock (&deque->mutex);
+      first = deque->first;
+      last = first + (deque->last - first + CHUNK_DIVISOR - 1) / CHUNK_DIVISOR;
+      deque->first = last;
+      g_mutex_unlock (&deque->mutex);
+      if (first == last)
+        {
+          if (!sprinkler_steal (data))
+            break;
+          continue;
+        }
+      data->chunk = (SprinklerChunk *)
+        g_realloc (data->chunk, (data->nchunks + 1) * sizeof (SprinklerChunk));
+      chunk = data->chunk + data->nchunks++;
+      chunk->first = first;
+      chunk->thread = data->thread;
+      chunk->begin = data->file ? ftell (data->file) : 0;
+      for (i = first; i < last; ++i)
+        {
+          begin = data->first + i * data->block_drops;
+          end = MIN (begin + data->block_drops, data->last);
+          sprinkler_clear (data->sprinkler);
+          for (j = begin; j < end; ++j)
+            sprinkler_drop (data->sprinkler, data->air, data->trajectory, rng,
+                            j, data->file);
+          sprinkler_pack (data->sprinkler,
+                          data->block + i * data->block_size);
+          data->load->drops += end - begin;
+        }
+      chunk->end = data->file ? ftell (data->file) : 0;
+    }
+  gsl_rng_free (rng);
+  data->load->chunks = data->nchunks;
+  data->load->busy = 1e-6 * (g_get_monotonic_time () - busy);
+  if (trace_enabled)
+    {
+      trace_event ("worker", t0, trace_time ());
+      trace_flush ();
+    }
+  return NULL;
+}
+
+/**
+ * \fn static int sprinkler_chunk_compare (const void *a, const void *b)
+ * \brief function to compare the first blocks of two chunks with qsort.
+ * \param a
+ * \brief pointer to the first SprinklerChunk struct.
+ * \param b
+ * \brief pointer to the second SprinklerChunk struct.
+ * \return -1 if a<b, 1 if a>b, 0 if a=b.
+ */
+static int
+sprinkler_chunk_compare (const void *a, const void *b)
+{
+  unsigned int x, y;
+  x = ((const SprinklerChunk *) a)->first;
+  y = ((const SprinklerChunk *) b)->first;
+  return (x > y) - (x < y);
+}
+
+/**
+ * \fn int sprinkler_calculate_drops (Sprinkler * s, Air * a, FILE * file, \
+ *   unsigned int first, unsigned int last, unsigned int n, \
+ *   SprinklerLoad * load)
+ * \brief function to calculate a range of sprinkler drops in parallel threads
+ *   with a work stealing scheduler. The range is divided in at most
+ *   SPRINKLER_BLOCKS blocks of drops. Every thread starts with a contiguous
+ *   range of blocks and the idle threads steal blocks to the busy ones, so the
+ *   threads are balanced although the cost of the drops is very different.
+ *   The measurements of the chunks are written in the drops order and the
+ *   drops data of the blocks, fixed by the range, are summed in the blocks
+ *   order, so the results, also the rounding of the sums, do not depend on
+ *   the threads number nor on the scheduling.
+ * \param s
+ * \brief Sprinkler struct.
+ * \param a
+ * \brief Air struct.
+ * \param file
+ * \brief measurements file.
+ * \param first
+ * \brief first drop.
+ * \param last
+ * \brief last drop (not calculated).
+ * \param n
+ * \brief threads number.
+ * \param load
+ * \brief array of the load balance statistics of the threads (unused threads
+ *   are set to 0) or NULL.
+ * \return 1 on success, 0 on error.
+ */
+int
+sprinkler_calculate_drops (Sprinkler * s, Air * a, FILE * file,
+                           unsigned int first, unsigned int last,
+                           unsigned int n, SprinklerLoad * load)
+{
+  SprinklerThread *data;
+  SprinklerDeque *deque;
+  SprinklerChunk *chunk;
+  GThread **thread;
+  double *block, *x;
+  unsigned long long int t0, t1;
+  unsigned int i, j, nchunks, nblocks, block_drops, block_size;
+#if DEBUG_SPRINKLER
+  fprintf (stderr, "sprinkler_calculate_drops: start\n");
+#endif
+  if (load)
+    memset (load, 0, n * sizeof (SprinklerLoad));
+  if (last <= first)
+    goto exit_calculate;
+  block_drops = (last - first + SPRINKLER_BLOCKS - 1) / SPRINKLER_BLOCKS;
+  nblocks = (last - first + block_drops - 1) / block_drops;
+  block_size = sprinkler_size (s);
+  n = MAX (1, MIN (n, nblocks));
+  data = (SprinklerThread *) g_malloc (n * sizeof (SprinklerThread));
+  for (i = 0; i < n; ++i)
+    {
+      data[i].file = NULL;
+      if (file && !(data[i].file = tmpfile ()))
+        {
+          sprinkler_error (gettext ("unable to open a temporary file"));
+          for (j = 0; j < i; ++j)
+            fclose (data[j].file);
+          g_free (data);
+          return 0;
+        }
+    }
+  deque = (SprinklerDeque *) g_malloc (n * sizeof (SprinklerDeque));
+  thread = (GThread **) g_malloc (n * sizeof (GThread *));
+  block = (double *) g_malloc (nblocks * block_size * sizeof (double));
+  for (i = 0; i < n; ++i)
+    {
+      g_mutex_init (&deque[i].mutex);
+      deque[i].first = i * nblocks / n;
+      deque[i].last = (i + 1) * nblocks / n;
+    }
+  for (i = 0; i < n; ++i)
+    {
+      sprinkler_copy (data[i].sprinkler, s);
+      memcpy (data[i].air, a, sizeof (Air));
+      memset (data[i].load, 0, sizeof (SprinklerLoad));
+      data[i].deque = deque;
+      data[i].chunk = NULL;
+      data[i].block = block;
+      data[i].first = first;
+      data[i].last = last;
+      data[i].block_drops = block_drops;
+      data[i].block_size = block_size;
+      data[i].nchunks = 0;
+      data[i].thread = i;
+      data[i].nthreads = n;
+      thread[i] = g_thread_new (NULL, (GThreadFunc) sprinkler_thread, data + i);
+    }
+  if (trace_enabled)
+    t0 = trace_time ();
+  for (i = nchunks = 0; i < n; ++i)
+    {
+      g_thread_join (thread[i]);
+      if (load)
+        memcpy (load + i, data[i].load, sizeof (SprinklerLoad));
+      sprinkler_free (data[i].sprinkler);
+      nchunks += data[i].nchunks;
+    }
+
+  // summing the drops data of the blocks in the drops order
+  x = (double *) g_malloc (block_size * sizeof (double));
+  sprinkler_pack (s, x);
+  for (i = 0; i < nblocks; ++i)
+    for (j = 0; j < block_size; ++j)
+      x[j] += block[i * block_size + j];
+  sprinkler_unpack (s, x);
+  g_free (x);
+  g_free (block);
+  if (trace_enabled)
+    {
+      t1 = trace_time ();
+      trace_event ("wait", t0, t1);
+      t0 = t1;
+    }
+
+  // writing the chunks measurements in the drops order
+  if (file)
+    {
+      chunk = (SprinklerChunk *) g_malloc (nchunks * sizeof (SprinklerChunk));
+      for (i = nchunks = 0; i < n; ++i)
+        {
+          memcpy (chunk + nchunks, data[i].chunk,
+                  data[i].nchunks * sizeof (SprinklerChunk));
+          nchunks += data[i].nchunks;
+        }
+      qsort (chunk, nchunks, sizeof (SprinklerChunk), sprinkler_chunk_compare);
+      for (j = 0; j < nchunks; ++j)
+        file_copy (file, data[chunk[j].thread].file, chunk[j].begin,
+                   chunk[j].end);
+      g_free (chunk);
+      for (i = 0; i < n; ++i)
+        fclose (data[i].file);
+      if (trace_enabled)
+        trace_event ("output flush", t0, trace_time ());
+    }
+  if (trace_enabled)
+    trace_flush ();
+  for (i = 0; i < n; ++i)
+    {
+      g_free (data[i].chunk);
+      g_mutex_clear (&deque[i].mutex);
+    }
+  g_free (thread);
+  g_free (deque);
+  g_free (data);
+
+exit_calculate:
+#if DEBUG_SPRINKLER
+  fprintf (stderr, "sprinkler_calculate_drops: end\n");
+#endif
+  return 1;
+}
+
+/**
+ * \fn int sprinkler_calculate (Sprinkler * s, Air * a, FILE * file, \
+ *   unsigned int n, SprinklerLoad * load)
+ * \brief function to calculate all the sprinkler drops in parallel threads.
+ * \param s
+ * \brief Sprinkler struct.
+ * \param a
+ * \brief Air struct.
+ * \param file
+ * \brief measurements file.
+ * \param n
+ * \brief threads number.
+ * \param load
+ * \brief array of the load balance statistics of the threads (unused threads
+ *   are set to 0) or NULL.
+ * \return 1 on success, 0 on error.
+ */
+int
+sprinkler_calculate (Sprinkler * s, Air * a, FILE * file, unsigned int n,
+                     SprinklerLoad * load)
+{
+  return sprinkler_calculate_drops (s, a, file, 0, s->ntrajectories, n, load);
+}
+
+/**
+ * \fn int sprinkler_converged (Sprinkler * s, unsigned int n, double z)
+ * \brief function to check if the frequency of the collected drops and their
+ *   mean velocity reach the target relative error on every controlling
+ *   measurement.
+ * \param s
+ * \brief Sprinkler struct.
+ * \param n
+ * \brief number of calculated drops.
+ * \param z
+ * \brief standard normal quantile of the confidence level.
+ * \return 1 if converged, 0 otherwise.
+ */
+static int
+sprinkler_converged (Sprinkler * s, unsigned int n, double z)
+{
+  Measurement *m;
+  double f, df, v, dv;
+  unsigned int i;
+  for (i = 0; i < s->nmeasurements; ++i)
+    {
+      m = s->measurement + i;
+      if (!m->convergence)
+        continue;
+      measurement_statistics (m, n, z, &f, &df, &v, &dv);
+      if (!m->nhits || df > s->relative_error * f
+          || dv > s->relative_error * v)
+        return 0;
+    }
+  return 1;
+}
+
+#if HAVE_MPI
+
+/**
+ * \fn void sprinkler_mpi_reduce (Sprinkler * s)
+ * \brief function to sum on the first MPI rank the drops collected or landed
+ *   on all the ranks. The numbers of hits are exactly summed as doubles.
+ * \param s
+ * \brief Sprinkler struct.
+ */
+void
+sprinkler_mpi_reduce (Sprinkler * s)
+{
+  double *x;
+  unsigned int n;
+  n = sprinkler_size (s);
+  x = (double *) g_malloc (n * sizeof (double));
+  sprinkler_pack (s, x);
+  MPI_Reduce (mpi_rank ? x : MPI_IN_PLACE, x, n, MPI_DOUBLE, MPI_SUM, 0,
+              MPI_COMM_WORLD);
+  if (!mpi_rank)
+    sprinkler_unpack (s, x);
+  g_free (x);
+}
+
+#endif
+
+/**
+ * \fn static int sprinkler_converged_ranks (Sprinkler * s, unsigned int n, \
+ *   double z)
+ * \brief function to check the convergence on the drops calculated by all the
+ *   MPI ranks. The first rank checks the summed drops data and broadcasts the
+ *   result, so all the ranks stop on the same batch.
+ * \param s
+ * \brief Sprinkler struct.
+ * \param n
+ * \brief number of calculated drops by all the ranks.
+ * \param z
+ * \brief standard normal quantile of the confidence level.
+ * \return 1 if converged, 0 otherwise.
+ */
+static int
+sprinkler_converged_ranks (Sprinkler * s, unsigned int n, double z)
+{
+#if HAVE_MPI
+  Sprinkler total[1];
+  int converged;
+  if (mpi_size == 1)
+    return sprinkler_converged (s, n, z);
+  sprinkler_copy (total, s);
+  sprinkler_add (total, s);
+  sprinkler_mpi_reduce (total);
+  converged = !mpi_rank && sprinkler_converged (total, n, z);
+  sprinkler_free (total);
+  MPI_Bcast (&converged, 1, MPI_INT, 0, MPI_COMM_WORLD);
+  return converged;
+#else
+  return sprinkler_converged (s, n, z);
+#endif
+}
+
+/**
+ * \fn int sprinkler_checkpoint_write (Sprinkler * s, FILE * file, \
+ *   unsigned int drops)
+ * \brief function to write the checkpoint file of a sprinkler run. The drops
+ *   have their own pseudo-random numbers substreams, so the number of
+ *   calculated drops, the collected drops data and the measurements file
+ *   length are enough to resume the run. The floating point numbers are
+ *   written in hexadecimal to be exactly restored, and the file is replaced
+ *   only when completely written. The radial profile is also saved.
+ * \param s
+ * \brief Sprinkler struct.
+ * \param file
+ * \brief measurements file.
+ * \param drops
+ * \brief number of calculated drops.
+ * \return 1 on success, 0 on error.
+ */
+int
+sprinkler_checkpoint_write (Sprinkler * s, FILE * file, unsigned int drops)
+{
+  Measurement *m;
+  FILE *checkpoint;
+  char *name;
+  long int offset;
+  unsigned int i;
+  int k;
+  offset = 0;
+  if (file)
+    {
+      fflush (file);
+      offset = ftell (file);
+    }
+  name = g_strconcat (checkpoint_name, ".tmp", NULL);
+  checkpoint = fopen (name, "w");
+  if (!checkpoint)
+    {
+      g_free (name);
+      sprinkler_error (gettext ("unable to write the checkpoint file"));
+      return 0;
+    }
+  fprintf (checkpoint, "%u %u %u %u %u %ld %a %a\n", s->ntrajectories,
+           s->nmeasurements, s->nrings, checkpoint_drops, drops, offset,
+           s->distance, s->volume);
+  for (i = 0; i < s->nmeasurements; ++i)
+    {
+      m = s->measurement + i;
+      fprintf (checkpoint, "%a %a %a %a %a %a %lu\n", m->volume, m->velocity,
+               m->weight, m->weight2, m->velocity_weight2, m->velocity2,
+               m->nhits);
+    }
+  for (i = 0; i < s->nrings; ++i)
+    fprintf (checkpoint, "%a\n", s->profile[i]);
+  k = ferror (checkpoint);
+  if (fclose (checkpoint) || k || g_rename (name, checkpoint_name))
+    {
+      g_free (name);
+      sprinkler_error (gettext ("unable to write the checkpoint file"));
+      return 0;
+    }
+  g_free (name);
+  return 1;
+}
+
+/**
+ * \fn int sprinkler_checkpoint_read (Sprinkler * s, FILE * file, \
+ *   unsigned int *drops)
+ * \brief function to resume a sprinkler run from its checkpoint file. The
+ *   measurements file is truncated to its length on the checkpoint.
+ * \param s
+ * \brief Sprinkler struct.
+ * \param file
+ * \brief measurements file.
+ * \param drops
+ * \brief pointer to the number of calculated drops.
+ * \return 1 on success, 0 on error.
+ */
+int
+sprinkler_checkpoint_read (Sprinkler * s, FILE * file, unsigned int *drops)
+{
+  Measurement *m;
+  FILE *checkpoint;
+  long int offset;
+  unsigned int i, ntrajectories, nmeasurements, nrings;
+  checkpoint = fopen (checkpoint_name, "r");
+  if (!checkpoint)
+    {
+      sprinkler_error (gettext ("unable to open the checkpoint file"));
+      return 0;
+    }
+  if (fscanf (checkpoint, "%u%u%u%u%u%ld%la%la", &ntrajectories,
+              &nmeasurements, &nrings, &checkpoint_drops, drops, &offset,
+              &s->distance, &s->volume) != 8
+      || ntrajectories != s->ntrajectories
+      || nmeasurements != s->nmeasurements || nrings != s->nrings
+      || !checkpoint_drops || *drops > ntrajectories)
+    goto bad_checkpoint;
+  for (i = 0; i < s->nmeasurements; ++i)
+    {
+      m = s->measurement + i;
+      if (fscanf (checkpoint, "%la%la%la%la%la%la%lu", &m->volume,
+                  &m->velocity, &m->weight, &m->weight2,
+                  &m->velocity_weight2, &m->velocity2, &m->nhits) != 7)
+        goto bad_checkpoint;
+    }
+  for (i = 0; i < s->nrings; ++i)
+    if (fscanf (checkpoint, "%la", s->profile + i) != 1)
+      goto bad_checkpoint;
+  fclose (checkpoint);
+  if (file)
+    {
+      fflush (file);
+      if (ftruncate (fileno (file), offset) || fseek (file, offset, SEEK_SET))
+        {
+          sprinkler_error (gettext ("unable to truncate the measurements "
+                                    "file"));
+          return 0;
+        }
+    }
+  return 1;
+
+bad_checkpoint:
+  fclose (checkpoint);
+  sprinkler_error (gettext ("bad checkpoint file"));
+  return 0;
+}
+
+/**
+ * \fn int sprinkler_calculate_batches (Sprinkler * s, Air * a, FILE * file, \
+ *   unsigned int first, unsigned int n)
+ * \brief function to calculate the sprinkler drops from the first one in
+ *   batches. On convergence runs the calculation stops when the frequency of
+ *   the collected drops and their mean velocity reach the target relative
+ *   error on every controlling measurement, the number of calculated drops is
+ *   set in the Sprinkler struct and the convergence statistics are shown. A
+ *   checkpoint is written every checkpoint_drops drops if a checkpoint file is
+ *   set. On MPI runs every rank calculates a contiguous block of every batch
+ *   and the drops data of all the ranks are summed on the first rank at the
+ *   end. With several threads the load balance statistics of every thread,
+ *   summed on all the batches, are shown.
+ * \param s
+ * \brief Sprinkler struct.
+ * \param a
+ * \brief Air struct.
+ * \param file
+ * \brief measurements file.
+ * \param first
+ * \brief first drop to calculate.
+ * \param n
+ * \brief threads number.
+ * \return 1 on success, 0 on error.
+ */
+int
+sprinkler_calculate_batches (Sprinkler * s, Air * a, FILE * file,
+                             unsigned int first, unsigned int n)
+{
+  Measurement *m;
+  SprinklerLoad *load, *total;
+  double z, f, df, v, dv;
+  unsigned int i, last, step, begin, end, converged;
+#if DEBUG_SPRINKLER
+  fprintf (stderr, "sprinkler_calculate_batches: start\n");
+#endif
+  n = MAX (1, n);
+  load = (SprinklerLoad *) g_malloc (n * sizeof (SprinklerLoad));
+  total = (SprinklerLoad *) g_malloc0 (n * sizeof (SprinklerLoad));
+  converged = 0;
+  z = 0.;
+  if (s->batch)
+    {
+      step = s->batch;
+      z = gsl_cdf_ugaussian_Pinv (0.5 + 0.5 * s->confidence);
+      if (first)
+        converged = sprinkler_converged_ranks (s, first, z);
+    }
+  else if (checkpoint_name)
+    step = checkpoint_drops;
+  else
+    step = s->ntrajectories;
+  for (last = first; !converged && first < s->ntrajectories; first = last)
+    {
+      last = MIN (first + step, s->ntrajectories);
+      begin = first + (unsigned long long int) mpi_rank * (last - first)
+        / mpi_size;
+      end = first + (unsigned long long int) (mpi_rank + 1) * (last - first)
+        / mpi_size;
+      if (!sprinkler_calculate_drops (s, a, file, begin, end, n, load))
+        goto exit_on_error;
+      for (i = 0; i < n; ++i)
+        {
+          total[i].busy += load[i].busy;
+          total[i].drops += load[i].drops;
+          total[i].chunks += load[i].chunks;
+          total[i].steals += load[i].steals;
+        }
+      if (s->batch)
+        converged = sprinkler_converged_ranks (s, last, z);
+      if (checkpoint_name && last / checkpoint_drops > first / checkpoint_drops
+          && !sprinkler_checkpoint_write (s, file, last))
+        goto exit_on_error;
+    }
+#if HAVE_MPI
+  if (mpi_size > 1)
+    sprinkler_mpi_reduce (s);
+#endif
+  if (s->batch)
+    s->ntrajectories = last;
+  if (s->batch && !mpi_rank)
+    {
+      printf ("Convergence:\n\tdrops=%u\n\tconverged=%u\n", last,
+              converged);
+      for (i = 0; i < s->nmeasurements; ++i)
+        {
+          m = s->measurement + i;
+          measurement_statistics (m, last, z, &f, &df, &v, &dv);
+          printf ("\tx=%lg y=%lg frequency=%lg+-%lg velocity=%lg+-%lg\n",
+                  m->x, m->y, f, df, v, dv);
+        }
+    }
+  if (n > 1)
+    {
+      if (mpi_size > 1)
+        printf ("Load of rank %d:\n", mpi_rank);
+      else
+        printf ("Load:\n");
+      for (i = 0; i < n; ++i)
+        printf ("\tthread=%u busy=%lgs drops=%u chunks=%u steals=%u\n", i,
+                total[i].busy, total[i].drops, total[i].chunks,
+                total[i].steals);
+    }
+  g_free (total);
+  g_free (load);
+#if DEBUG_SPRINKLER
+  fprintf (stderr, "sprinkler_calculate_batches: end\n");
+#endif
+  return 1;
+
+exit_on_error:
+  g_free (total);
+  g_free (load);
+#if DEBUG_SPRINKLER
+  fprintf (stderr, "sprinkler_calculate_batches: end\n");
+#endif
+  return 0;
+}
+
+/**
+ * \fn int sprinkler_write_radial (Sprinkler * s, char *result)
+ * \brief function to write the radial profile of the sprinkler pattern and to
+ *   rotate it on a 2D grid. In calm air the pattern of a rotating sprinkler is
+ *   rotationally symmetric, so the drops landed on every ring define the
+ *   pattern on the angular sector covered by the sprinkler, and on the full
+ *   circle if the minimum and maximum angles are equal. On the full circle
+ *   every drop is thrown along the single radius of the minimum angle, as the
+ *   landing distance does not depend on the direction in calm air. The depth
+ *   is normalized by the volume of all calculated drops, so it has to be
+ *   multiplied by the emitted water volume. The profile is linearly
+ *   interpolated between the ring centers.
+ * \param s
+ * \brief Sprinkler struct.
+ * \param result
+ * \brief result file name prefix.
+ * \return 1 on success, 0 on error.
+ */
+int
+sprinkler_write_radial (Sprinkler * s, char *result)
+{
+  FILE *file;
+  char *name;
+  double *depth;
+  double arc, dr, x, y, r, angle;
+  unsigned int i, j, k, n;
+#if DEBUG_SPRINKLER
+  fprintf (stderr, "sprinkler_write_radial: start\n");
+#endif
+  arc = s->angle_max - s->angle_min;
+  if (arc <= 0. || arc > 360.)
+    arc = 360.;
+  dr = s->radius / s->nrings;
+  depth = (double *) g_malloc (s->nrings * sizeof (double));
+  for (i = 0; i < s->nrings; ++i)
+    depth[i] = (s->volume > 0.) ? s->profile[i]
+      / (s->volume * arc / 360. * M_PI * (2 * i + 1) * dr * dr) : 0.;
+  name = g_strconcat (result, "-profile", NULL);
+  file = fopen (name, "w");
+  g_free (name);
+  if (!file)
+    goto exit_on_error;
+  for (i = 0; i < s->nrings; ++i)
+    fprintf (file, "%lg %lg\n", (i + 0.5) * dr, depth[i]);
+  fclose (file);
+  name = g_strconcat (result, "-grid", NULL);
+  file = fopen (name, "w");
+  g_free (name);
+  if (!file)
+    goto exit_on_error;
+  n = (unsigned int) ceil (s->radius / s->grid_step);
+  for (i = 0; i <= 2 * n; ++i)
+    {
+      x = ((double) i - n) * s->grid_step;
+      for (j = 0; j <= 2 * n; ++j)
+        {
+          y = ((double) j - n) * s->grid_step;
+          r = sqrt (x * x + y * y) / dr - 0.5;
+          angle = atan2 (y, x) * 180. / M_PI - s->angle_min;
+          angle = fmod (angle + 720., 360.);
+          if (r >= s->nrings - 0.5 || angle > arc)
+            fprintf (file, "%lg %lg 0\n", s->x + x, s->y + y);
+          else if (r <= 0.)
+            fprintf (file, "%lg %lg %lg\n", s->x + x, s->y + y, depth[0]);
+          else
+            {
+              k = (unsigned int) r;
+              if (k >= s->nrings - 1)
+                k = s->nrings - 2;
+              fprintf (file, "%lg %lg %lg\n", s->x + x, s->y + y,
+                       depth[k] + (r - k) * (depth[k + 1] - depth[k]));
+            }
+        }
+      fprintf (file, "\n");
+    }
+  fclose (file);
+  g_free (depth);
+#if DEBUG_SPRINKLER
+  fprintf (stderr, "sprinkler_write_radial: end\n");
+#endif
+  return 1;
 
-#define DEBUG_SPRINKLER 1       ///< macro to debug sprinkler functions.
+exit_on_error:
+  g_free (depth);
+  sprinkler_error (gettext ("unable to open the radial pattern files"));
+#if DEBUG_SPRINKLER
+  fprintf (stderr, "sprinkler_write_radial: end\n");
+#endif
+  return 0;
+}
 
 /**
- * \fn void trajectory_init_with_sprinkler (Trajectory *t, Sprinkler *s)
- * \brief function to init drop trajectory variables from sprinkler data.
- * \param t
- * \brief Trajectory struct.
+ * \fn void sprinkler_uniformity (Sprinkler * s)
+ * \brief function to calculate the uniformity statistics of the depths on the
+ *   measurements from the drop volumes collected during the run. The depth of
+ *   a measurement is the collected volume per calculated drop and per unit of
+ *   collector area (the collected volume per calculated drop on point
+ *   collectors).
  * \param s
  * \brief Sprinkler struct.
  */
 void
-trajectory_init_with_sprinkler (Trajectory * t, Sprinkler * s)
+sprinkler_uniformity (Sprinkler * s)
 {
-  Drop *d;
-  double v, k2, k3;
+  Measurement *m;
+  double *depth;
+  double area, deviation;
+  unsigned int i;
 #if DEBUG_SPRINKLER
-  fprintf (stderr, "trajectory_init_with_sprinkler: start\n");
+  fprintf (stderr, "sprinkler_uniformity: start\n");
 #endif
-  d = t->drop;
-  t->t = 0.;
-  t->cfl = s->cfl;
-  t->dt = s->dt;
-  t->bed_level = s->bed_level;
-  t->drop_maximum_diameter = s->drop_dmax;
-  d->r[0] = s->x;
-  d->r[1] = s->y;
-  d->r[2] = s->z;
-  v = sqrt (2. * s->pressure / d->density);
-  k2 = s->horizontal_angle * M_PI / 180.;
-  k3 = s->vertical_angle * M_PI / 180.;
-  d->v[0] = v * cos (k3) * cos (k2);
-  d->v[1] = v * cos (k3) * sin (k2);
-  d->v[2] = v * sin (k3);
+  depth = (double *) g_malloc (s->nmeasurements * sizeof (double));
+  for (i = 0; i < s->nmeasurements; ++i)
+    {
+      m = s->measurement + i;
+      area = 4. * m->dx * m->dy;
+      depth[i] = s->ntrajectories ? m->volume / s->ntrajectories : 0.;
+      if (area > 0.)
+        depth[i] /= area;
+    }
+  uniformity (depth, s->nmeasurements, &s->mean, &deviation, &s->cu, &s->du);
+  s->variance = deviation * deviation;
+  g_free (depth);
 #if DEBUG_SPRINKLER
-  fprintf (stderr, "trajectory_init_with_sprinkler: Time step size=%le\n",
-           t->dt);
-  fprintf (stderr, "trajectory_init_with_sprinkler: Water pressure=%le "
-           "Drop density=%le\n", s->pressure, d->density);
-  fprintf (stderr, "trajectory_init_with_sprinkler: "
-           "Drop velocity=(%le,%le,%le)\n", d->v[0], d->v[1], d->v[2]);
-  fprintf (stderr, "trajectory_init_with_sprinkler: Jet time=%lg\n",
-           t->jet_time);
-  fprintf (stderr, "trajectory_init_with_sprinkler: end\n");
+  fprintf (stderr, "sprinkler_uniformity: end\n");
 #endif
 }
 
 /**
- * \fn void trajectory_open_with_sprinkler (Trajectory *t, Sprinkler *s, \
- *   Air * a, gsl_rng * rng)
- * \brief function to init drop trajectory variables from sprinkler data.
- * \param t
- * \brief Trajectory struct.
+ * \fn int sprinkler_write_uniformity (Sprinkler * s, char *result)
+ * \brief function to show the uniformity statistics of the measurements and
+ *   to write them on the "result-uniformity" file as a single row:
+ *   "mean variance CU DU".
  * \param s
  * \brief Sprinkler struct.
- * \param a
- * \brief Air struct.
- * \param rng
- * \brief GSL pseudo-random numbers generator struct.
+ * \param result
+ * \brief result file name prefix.
+ * \return 1 on success, 0 on error.
  */
-void
-trajectory_open_with_sprinkler (Trajectory * t, Sprinkler * s, Air * a,
-                                gsl_rng * rng)
+int
+sprinkler_write_uniformity (Sprinkler * s, char *result)
 {
-  double diameter;
+  FILE *file;
+  char *name;
 #if DEBUG_SPRINKLER
-  fprintf (stderr, "trajectory_open_with_sprinkler: start\n");
+  fprintf (stderr, "sprinkler_write_uniformity: start\n");
 #endif
-  diameter
-    = s->drop_dmin + (s->drop_dmax - s->drop_dmin) * gsl_rng_uniform (rng);
-  s->horizontal_angle
-    = s->angle_min + (s->angle_max - s->angle_min) * gsl_rng_uniform (rng);
-  trajectory_open_data (t, a, rng, diameter, s->jet_model, s->detach_model,
-                        s->drag_model, s->drag_coefficient, s->drop_dmax);
+  sprinkler_uniformity (s);
+  printf ("Uniformity:\n\tmean=%lg\n\tvariance=%lg\n\tCU=%lg\n\tDU=%lg\n",
+          s->mean, s->variance, s->cu, s->du);
+  name = g_strconcat (result, "-uniformity", NULL);
+  file = fopen (name, "w");
+  g_free (name);
+  if (!file)
+    {
+      sprinkler_error (gettext ("unable to open the uniformity file"));
 #if DEBUG_SPRINKLER
-  fprintf (stderr, "trajectory_open_with_sprinkler: end\n");
+      fprintf (stderr, "sprinkler_write_uniformity: end\n");
+#endif
+      return 0;
+    }
+  fprintf (file, "%lg %lg %lg %lg\n", s->mean, s->variance, s->cu, s->du);
+  fclose (file);
+#if DEBUG_SPRINKLER
+  fprintf (stderr, "sprinkler_write_uniformity: end\n");
 #endif
+  return 1;
 }
 
 /**
@@ -142,6 +1286,99 @@ sprinkler_error (char *message)
   error_message = g_strconcat (gettext ("Sprinkler file"), ": ", message, NULL);
 }
 
+/**
+ * \fn int sprinkler_open_distribution (Sprinkler * s, char *name, \
+ *   unsigned int columns, unsigned int diameter_column, \
+ *   unsigned int distance_column)
+ * \brief function to open an empirical drops distribution from a file of
+ *   measured drops and to build its alias table. Every row of the file has the
+ *   data of a measured drop. If the landing distance of the drops is given,
+ *   every drop is weighted by its distance to account for the perimeter of its
+ *   landing ring, else all drops have the same weight.
+ * \param s
+ * \brief Sprinkler struct.
+ * \param name
+ * \brief name of the measured drops file.
+ * \param columns
+ * \brief number of columns of the file.
+ * \param diameter_column
+ * \brief number of the column of the drop diameters (starting on 1).
+ * \param distance_column
+ * \brief number of the column of the drop landing distances (starting on 1,
+ *   0 if the drops are not weighted).
+ * \return 1 on success, 0 on error.
+ */
+int
+sprinkler_open_distribution (Sprinkler * s, char *name, unsigned int columns,
+                             unsigned int diameter_column,
+                             unsigned int distance_column)
+{
+  FILE *file;
+  double *row;
+  unsigned int i;
+#if DEBUG_SPRINKLER
+  fprintf (stderr, "sprinkler_open_distribution: start\n");
+#endif
+  if (!diameter_column || diameter_column > columns
+      || distance_column > columns)
+    {
+      sprinkler_error (gettext ("bad distribution columns"));
+      goto exit_on_error;
+    }
+  file = fopen (name, "r");
+  if (!file)
+    {
+      sprinkler_error (gettext ("unable to open the distribution file"));
+      goto exit_on_error;
+    }
+  row = (double *) g_malloc (columns * sizeof (double));
+  for (;;)
+    {
+      for (i = 0; i < columns && fscanf (file, "%lf", row + i) == 1; ++i);
+      if (!i)
+        break;
+      if (i < columns || row[diameter_column - 1] <= 0.
+          || (distance_column && row[distance_column - 1] < 0.))
+        {
+          sprinkler_error (gettext ("bad distribution file"));
+          g_free (row);
+          fclose (file);
+          goto exit_on_error;
+        }
+      s->distribution
+        = g_realloc (s->distribution,
+                     (s->ndistribution + 1) * sizeof (double));
+      s->distribution_probability
+        = g_realloc (s->distribution_probability,
+                     (s->ndistribution + 1) * sizeof (double));
+      s->distribution[s->ndistribution] = row[diameter_column - 1];
+      s->distribution_probability[s->ndistribution]
+        = distance_column ? row[distance_column - 1] : 1.;
+      ++s->ndistribution;
+    }
+  g_free (row);
+  fclose (file);
+  if (!s->ndistribution)
+    {
+      sprinkler_error (gettext ("empty distribution file"));
+      goto exit_on_error;
+    }
+  s->distribution_alias
+    = (unsigned int *) g_malloc (s->ndistribution * sizeof (unsigned int));
+  alias_table (s->distribution_probability, s->distribution_alias,
+               s->ndistribution);
+#if DEBUG_SPRINKLER
+  fprintf (stderr, "sprinkler_open_distribution: end\n");
+#endif
+  return 1;
+
+exit_on_error:
+#if DEBUG_SPRINKLER
+  fprintf (stderr, "sprinkler_open_distribution: end\n");
+#endif
+  return 0;
+}
+
 /**
  * \fn void sprinkler_open_console (Sprinkler *s)
  * \brief function to input a Sprinkler struct in console.
@@ -176,22 +1413,38 @@ sprinkler_open_console (Sprinkler * s)
 }
 
 /**
- * \fn int sprinkler_open_xml (Sprinkler *s, xmlNode *node)
- * \brief function to open a Sprinkler struct on a XML node.
+ * \fn int sprinkler_open_xml (Sprinkler *s, Air *a, xmlNode *node)
+ * \brief function to open a Sprinkler struct, the atmospheric conditions and
+ *   the measurement points on a XML node.
  * \param s
  * \brief Sprinkler struct.
+ * \param a
+ * \brief Air struct.
  * \param node
  * \brief XML node.
  * \return 1 on success, 0 on error.
  */
 int
-sprinkler_open_xml (Sprinkler * s, xmlNode * node)
+sprinkler_open_xml (Sprinkler * s, Air * a, xmlNode * node)
 {
+  Measurement m[1];
   xmlChar *buffer;
+  unsigned int columns, diameter_column, distance_column;
   int k;
 #if DEBUG_SPRINKLER
   fprintf (stderr, "sprinkler_open_xml: start\n");
 #endif
+  s->measurement = NULL;
+  s->nmeasurements = 0;
+  s->distribution = s->distribution_probability = NULL;
+  s->distribution_alias = NULL;
+  s->ndistribution = 0;
+  s->distance = 0.;
+  s->relative_error = 0.;
+  s->batch = 0;
+  s->profile = NULL;
+  s->nrings = 0;
+  s->volume = 0.;
   if (xmlStrcmp (node->name, XML_SPRINKLER))
     {
       sprinkler_error (gettext ("bad label"));
@@ -336,6 +1589,7 @@ sprinkler_open_xml (Sprinkler * s, xmlNode * node)
           if (!k)
             {
               sprinkler_error (gettext ("bad drag value"));
+              xmlFree (buffer);
               goto exit_on_error;
             }
         }
@@ -346,6 +1600,7 @@ sprinkler_open_xml (Sprinkler * s, xmlNode * node)
       else
         {
           sprinkler_error (gettext ("unknown drag resistance model"));
+          xmlFree (buffer);
           goto exit_on_error;
         }
       xmlFree (buffer);
@@ -357,8 +1612,156 @@ sprinkler_open_xml (Sprinkler * s, xmlNode * node)
       else
         {
           sprinkler_error (gettext ("unknown jet detach model"));
+          xmlFree (buffer);
+          goto exit_on_error;
+        }
+      xmlFree (buffer);
+      buffer = xmlGetProp (node, XML_DIAMETER_SAMPLING);
+      if (!buffer || !xmlStrcmp (buffer, XML_UNIFORM))
+        s->diameter_sampling = SPRINKLER_DIAMETER_SAMPLING_UNIFORM;
+      else if (!xmlStrcmp (buffer, XML_STRATIFIED))
+        s->diameter_sampling = SPRINKLER_DIAMETER_SAMPLING_STRATIFIED;
+      else if (!xmlStrcmp (buffer, XML_VOLUME))
+        s->diameter_sampling = SPRINKLER_DIAMETER_SAMPLING_VOLUME;
+      else if (!xmlStrcmp (buffer, XML_EMPIRICAL))
+        s->diameter_sampling = SPRINKLER_DIAMETER_SAMPLING_EMPIRICAL;
+      else
+        {
+          sprinkler_error (gettext ("unknown diameter sampling type"));
+          xmlFree (buffer);
+          goto exit_on_error;
+        }
+      xmlFree (buffer);
+      if (s->diameter_sampling == SPRINKLER_DIAMETER_SAMPLING_EMPIRICAL)
+        {
+          columns = xml_node_get_uint_with_default (node, XML_COLUMNS, 1, &k);
+          if (!k)
+            {
+              sprinkler_error (gettext ("bad distribution columns"));
+              goto exit_on_error;
+            }
+          diameter_column
+            = xml_node_get_uint_with_default (node, XML_DIAMETER_COLUMN, 1,
+                                              &k);
+          if (!k)
+            {
+              sprinkler_error (gettext ("bad distribution columns"));
+              goto exit_on_error;
+            }
+          distance_column
+            = xml_node_get_uint_with_default (node, XML_DISTANCE_COLUMN, 0,
+                                              &k);
+          if (!k)
+            {
+              sprinkler_error (gettext ("bad distribution columns"));
+              goto exit_on_error;
+            }
+          buffer = xmlGetProp (node, XML_DISTRIBUTION);
+          if (!buffer)
+            {
+              sprinkler_error (gettext ("no distribution file"));
+              goto exit_on_error;
+            }
+          k = sprinkler_open_distribution (s, (char *) buffer, columns,
+                                           diameter_column, distance_column);
+          xmlFree (buffer);
+          if (!k)
+            goto exit_on_error;
+        }
+      buffer = xmlGetProp (node, XML_SAMPLING);
+      if (!buffer || !xmlStrcmp (buffer, XML_RANDOM))
+        s->sampling = SPRINKLER_SAMPLING_RANDOM;
+      else if (!xmlStrcmp (buffer, XML_SOBOL))
+        s->sampling = SPRINKLER_SAMPLING_SOBOL;
+      else
+        {
+          sprinkler_error (gettext ("unknown sampling type"));
+          xmlFree (buffer);
+          goto exit_on_error;
+        }
+      xmlFree (buffer);
+      s->relative_error
+        = xml_node_get_float_with_default (node, XML_RELATIVE_ERROR, 0., &k);
+      if (!k || s->relative_error < 0.)
+        {
+          sprinkler_error (gettext ("bad relative error"));
+          goto exit_on_error;
+        }
+      if (s->relative_error > 0.)
+        {
+          s->confidence
+            = xml_node_get_float_with_default (node, XML_CONFIDENCE,
+                                               CONFIDENCE, &k);
+          if (!k || s->confidence <= 0. || s->confidence >= 1.)
+            {
+              sprinkler_error (gettext ("bad confidence"));
+              goto exit_on_error;
+            }
+          s->batch
+            = xml_node_get_uint_with_default (node, XML_BATCH_DROPS,
+                                              BATCH_DROPS, &k);
+          if (!k || !s->batch)
+            {
+              sprinkler_error (gettext ("bad batch drops number"));
+              goto exit_on_error;
+            }
+
+          // complete batches to keep the stratification
+          s->ntrajectories
+            = (s->ntrajectories + s->batch - 1) / s->batch * s->batch;
+        }
+      // the profile is interpolated between at least two ring centers
+      s->nrings = xml_node_get_uint_with_default (node, XML_RINGS, 0, &k);
+      if (!k || s->nrings == 1)
+        {
+          s->nrings = 0;
+          sprinkler_error (gettext ("bad rings number"));
           goto exit_on_error;
         }
+      if (s->nrings)
+        {
+          s->radius = xml_node_get_float (node, XML_RADIUS, &k);
+          if (!k || s->radius <= 0.)
+            {
+              s->nrings = 0;
+              sprinkler_error (gettext ("bad radius"));
+              goto exit_on_error;
+            }
+          s->grid_step
+            = xml_node_get_float_with_default (node, XML_GRID_STEP,
+                                               s->radius / 50., &k);
+          if (!k || s->grid_step <= 0.)
+            {
+              s->nrings = 0;
+              sprinkler_error (gettext ("bad grid step"));
+              goto exit_on_error;
+            }
+          s->profile = g_malloc0 (s->nrings * sizeof (double));
+        }
+    }
+  node = node->children;
+  if (!node)
+    {
+      sprinkler_error (gettext ("no air"));
+      goto exit_on_error;
+    }
+  if (!air_open_xml (a, node))
+    goto exit_on_error;
+  if (s->nrings && (a->velocity != 0. || a->uncertainty != 0.))
+    {
+      sprinkler_error (gettext ("radial symmetry requires calm air"));
+      goto exit_on_error;
+    }
+  for (node = node->next; node && !xmlStrcmp (node->name, XML_MEASUREMENT);
+       node = node->next)
+    {
+      if (!measurement_open_xml (m, node))
+        goto exit_on_error;
+      s->measurement
+        = g_realloc (s->measurement,
+                     (s->nmeasurements + 1) * sizeof (Measurement));
+      memcpy (s->measurement + s->nmeasurements, m, sizeof (Measurement));
+      ++s->nmeasurements;
     }
 #if DEBUG_SPRINKLER
   fprintf (stderr, "sprinkler_open_xml: end\n");
@@ -407,9 +1810,10 @@ sprinkler_run_console (Sprinkler * s, Air * a, Trajectory * t, char *result)
 }
 
 /**
- * \fn int sprinkler_run_xml (Sprinkler * s, Air * a, Trajectory * t, \
+ * \fn int sprinkler_run (Sprinkler * s, Air * a, Trajectory * t, \
  *   xmlNode * node, char *result)
- * \brief function to run the simulation open all data in a XML file.
+ * \brief function to run the simulation of an opened Sprinkler struct. The
+ *   Sprinkler struct is freed at the end.
  * \param s
  * \brief sprinkler struct.
  * \param a
@@ -417,52 +1821,43 @@ sprinkler_run_console (Sprinkler * s, Air * a, Trajectory * t, char *result)
  * \param t.
  * \brief Trajectory struct.
  * \param node
- * \brief XML node.
+ * \brief XML node of the sprinkler, to read its trajectories.
  * \param result
  * \brief result file name.
  * \return 1 on success, 0 on error.
  */
 int
-sprinkler_run_xml (Sprinkler * s, Air * a, Trajectory * t, xmlNode * node,
-                   char *result)
+sprinkler_run (Sprinkler * s, Air * a, Trajectory * t, xmlNode * node,
+               char *result)
 {
-  Measurement m[1];
   gsl_rng *rng;
   FILE *file;
-  unsigned int i;
+  char *name;
+  unsigned int first;
 #if DEBUG_SPRINKLER
-  fprintf (stderr, "sprinkler_run_xml: start\n");
+  fprintf (stderr, "sprinkler_run: start\n");
 #endif
   file = NULL;
   rng = gsl_rng_alloc (gsl_rng_taus);
   gsl_rng_set (rng, RANDOM_SEED);
-  if (!sprinkler_open_xml (s, node))
-    goto exit_on_error;
-  node = node->children;
-  if (!air_open_xml (a, node))
-    goto exit_on_error;
-  s->nmeasurements = 0;
-  for (node = node->next; node && !xmlStrcmp (node->name, XML_MEASUREMENT);
-       node = node->next)
-    {
-      if (!measurement_open_xml (m, node))
-        goto exit_on_error;
-      s->measurement
-        = g_realloc (s->measurement,
-                     (s->nmeasurements + 1) * sizeof (Measurement));
-      memcpy (s->measurement + s->nmeasurements, m, sizeof (Measurement));
-      ++s->nmeasurements;
-    }
+  for (node = node->children->next;
+       node && !xmlStrcmp (node->name, XML_MEASUREMENT); node = node->next);
   if (s->nmeasurements)
     {
-      file = fopen (result, "w");
+      // every MPI rank writes the drops it collects on its own file
+      if (mpi_size > 1)
+        name = g_strdup_printf ("%s.%d", result, mpi_rank);
+      else
+        name = g_strdup (result);
+      file = fopen (name, checkpoint_resume ? "r+" : "w");
+      g_free (name);
       if (!file)
         {
           sprinkler_error (gettext ("unable to open the measurements file"));
           goto exit_on_error;
         }
     }
-  for (; node; node = node->next)
+  for (; node && !mpi_rank; node = node->next)
     {
       if (!trajectory_open_xml (t, a, node, result))
         goto exit_on_error;
@@ -472,32 +1867,68 @@ sprinkler_run_xml (Sprinkler * s, Air * a, Trajectory * t, xmlNode * node,
       air_wind_uncertainty (a, rng);
       trajectory_calculate (t, a, s->measurement, s->nmeasurements, file);
     }
-  for (i = 0; i < s->ntrajectories; ++i)
-    {
-#if DEBUG_SPRINKLER
-      fprintf (stderr, "sprinkler_run_xml: trajectory=%u\n", i);
-#endif
-      trajectory_open_with_sprinkler (t, s, a, rng);
-      t->jet_time = s->jet_time;
-      trajectory_init (t, a, rng);
-      trajectory_init_with_sprinkler (t, s);
-      air_wind_uncertainty (a, rng);
-      trajectory_calculate (t, a, s->measurement, s->nmeasurements, file);
-    }
+  first = 0;
+  if (checkpoint_resume && !sprinkler_checkpoint_read (s, file, &first))
+    goto exit_on_error;
+  if (!sprinkler_calculate_batches (s, a, file, first, nthreads))
+    goto exit_on_error;
+  if (!mpi_rank && s->nrings && !sprinkler_write_radial (s, result))
+    goto exit_on_error;
+  if (!mpi_rank && s->nmeasurements && !sprinkler_write_uniformity (s, result))
+    goto exit_on_error;
   if (file)
     fclose (file);
+  sprinkler_free (s);
   gsl_rng_free (rng);
 #if DEBUG_SPRINKLER
-  fprintf (stderr, "sprinkler_run_xml: end\n");
+  fprintf (stderr, "sprinkler_run: end\n");
 #endif
   return 1;
 
 exit_on_error:
   show_error ();
+#if HAVE_MPI
+  if (mpi_size > 1)
+    MPI_Abort (MPI_COMM_WORLD, 4);
+#endif
+  if (file)
+    fclose (file);
+  sprinkler_free (s);
   gsl_rng_free (rng);
 #if DEBUG_SPRINKLER
-  fprintf (stderr, "sprinkler_run_xml: end\n");
+  fprintf (stderr, "sprinkler_run: end\n");
+#endif
+  return 0;
+}
+
+/**
+ * \fn int sprinkler_run_xml (Sprinkler * s, Air * a, Trajectory * t, \
+ *   xmlNode * node, char *result)
+ * \brief function to run the simulation open all data in a XML file.
+ * \param s
+ * \brief sprinkler struct.
+ * \param a
+ * \brief Air struct.
+ * \param t.
+ * \brief Trajectory struct.
+ * \param node
+ * \brief XML node.
+ * \param result
+ * \brief result file name.
+ * \return 1 on success, 0 on error.
+ */
+int
+sprinkler_run_xml (Sprinkler * s, Air * a, Trajectory * t, xmlNode * node,
+                   char *result)
+{
+  if (sprinkler_open_xml (s, a, node))
+    return sprinkler_run (s, a, t, node, result);
+  show_error ();
+#if HAVE_MPI
+  if (mpi_size > 1)
+    MPI_Abort (MPI_COMM_WORLD, 4);
 #endif
+  sprinkler_free (s);
   return 0;
 }
 
@@ -36,6 +36,33 @@ OF SUCH DAMAGE.
 #ifndef SPRINKLER__H
 #define SPRINKLER__H 1
 
+/**
+ * \enum SprinklerSampling
+ * \brief enum to define the sampling types of the sprinkler drops.
+ */
+enum SprinklerSampling
+{
+  SPRINKLER_SAMPLING_RANDOM = 0,        ///< pseudo-random numbers.
+  SPRINKLER_SAMPLING_SOBOL = 1  ///< scrambled Sobol quasi-random sequence.
+};
+
+/**
+ * \enum SprinklerDiameterSampling
+ * \brief enum to define the sampling types of the sprinkler drop diameters.
+ */
+enum SprinklerDiameterSampling
+{
+  SPRINKLER_DIAMETER_SAMPLING_UNIFORM = 0,
+  ///< uniform distribution of the diameters.
+  SPRINKLER_DIAMETER_SAMPLING_STRATIFIED = 1,
+  ///< stratified uniform distribution of the diameters.
+  SPRINKLER_DIAMETER_SAMPLING_VOLUME = 2,
+  ///< stratified mixture of the uniform distribution and a distribution
+  ///< proportional to the drop volume with statistical weights.
+  SPRINKLER_DIAMETER_SAMPLING_EMPIRICAL = 3
+    ///< stratified empirical distribution of measured diameters.
+};
+
 /**
  * \struct Sprinkler
  * \brief struct to define a sprinkler.
@@ -43,6 +70,15 @@ OF SUCH DAMAGE.
 typedef struct
 {
   Measurement *measurement;     ///< array of Measurement structs.
+  double *distribution;
+  ///< array of diameters of the empirical drops distribution.
+  double *distribution_probability;
+  ///< array of acceptance probabilities of the empirical distribution alias
+  ///< table.
+  unsigned int *distribution_alias;
+  ///< array of indexes of the empirical distribution alias table.
+  double *profile;
+  ///< array of drop volumes landed on every ring of the radial profile.
   double x;                     ///< position x component.
   double y;                     ///< position y component.
   double z;                     ///< position z component.
@@ -60,21 +96,140 @@ typedef struct
   ///< drop drag resistance coefficient for the constant model.
   double dt;                    ///< numerical time step size.
   double cfl;                   ///< stability number.
+  double distance;              ///< sum of the drop landing distances.
+  double volume;                ///< sum of the drop volumes on radial runs.
+  double radius;                ///< radius of the radial profile.
+  double grid_step;             ///< cell size of the radial pattern grid.
+  double relative_error;
+  ///< target relative error of the measurements (0 for a fixed drops number).
+  double confidence;            ///< confidence level of the relative error.
+  double mean;                  ///< mean depth of the measurements.
+  double variance;              ///< variance of the measurement depths.
+  double cu;                    ///< Christiansen uniformity coefficient.
+  double du;                    ///< distribution uniformity of the low quarter.
   unsigned int nmeasurements;   ///< number of measurements.
-  unsigned int ntrajectories;   ///< number of drop trajectories.
+  unsigned int ndistribution;
+  ///< number of diameters of the empirical drops distribution.
+  unsigned int nrings;
+  ///< number of rings of the radial profile (0 without radial symmetry).
+  unsigned int ntrajectories;
+  ///< number of drop trajectories (maximum number on convergence runs).
+  unsigned int batch;
+  ///< drops number of a convergence batch (0 for a fixed drops number).
   unsigned int jet_model;       ///< jet model type.
   unsigned int detach_model;    ///< jet detach model type.
   unsigned int drag_model;      ///< drop drag resistance model.
+  unsigned int sampling;        ///< drops sampling type.
+  unsigned int diameter_sampling;       ///< drop diameters sampling type.
 } Sprinkler;
 
+/**
+ * \struct SprinklerDeque
+ * \brief struct to define the range of blocks of drops pending on a thread.
+ *   The owner thread takes chunks from the front and the idle threads steal
+ *   the back half.
+ */
+typedef struct
+{
+  GMutex mutex;                 ///< mutex to access the range.
+  unsigned int first;           ///< first pending block.
+  unsigned int last;            ///< last pending block (not calculated).
+} SprinklerDeque;
+
+/**
+ * \struct SprinklerChunk
+ * \brief struct to define a chunk of blocks of drops calculated by a thread.
+ */
+typedef struct
+{
+  long int begin;
+  ///< start of the chunk measurements on the thread temporary file.
+  long int end;
+  ///< end of the chunk measurements on the thread temporary file.
+  unsigned int first;           ///< first block.
+  unsigned int thread;          ///< number of the calculating thread.
+} SprinklerChunk;
+
+/**
+ * \struct SprinklerLoad
+ * \brief struct to define the load balance statistics of a thread calculating
+ *   sprinkler drops.
+ */
+typedef struct
+{
+  double busy;                  ///< busy time in seconds.
+  unsigned int drops;           ///< number of calculated drops.
+  unsigned int chunks;          ///< number of calculated chunks.
+  unsigned int steals;          ///< number of ranges stolen to other threads.
+} SprinklerLoad;
+
+/**
+ * \struct SprinklerThread
+ * \brief struct to define the data of a thread calculating sprinkler drops.
+ */
+typedef struct
+{
+  Sprinkler sprinkler[1];       ///< Sprinkler struct copy.
+  Air air[1];                   ///< Air struct copy.
+  Trajectory trajectory[1];     ///< Trajectory struct.
+  SprinklerDeque *deque;        ///< array of pending blocks of all the threads.
+  SprinklerChunk *chunk;        ///< array of calculated chunks.
+  double *block;                ///< array of packed drops data of all blocks.
+  FILE *file;                   ///< temporary measurements file.
+  SprinklerLoad load[1];        ///< load balance statistics.
+  unsigned int first;           ///< first drop.
+  unsigned int last;            ///< last drop (not calculated).
+  unsigned int block_drops;     ///< drops number of a block.
+  unsigned int block_size;      ///< size of the packed drops data of a block.
+  unsigned int nchunks;         ///< number of calculated chunks.
+  unsigned int thread;          ///< thread number.
+  unsigned int nthreads;        ///< threads number.
+} SprinklerThread;
+
+extern char *checkpoint_name;
+extern unsigned int checkpoint_drops;
+extern unsigned int checkpoint_resume;
+extern int mpi_rank;
+extern int mpi_size;
+
 void trajectory_init_with_sprinkler (Trajectory * t, Sprinkler * s);
+double sprinkler_diameter (Sprinkler * s, unsigned int i, double u,
+                           double *weight);
 void trajectory_open_with_sprinkler (Trajectory * t, Sprinkler * s, Air * a,
-                                     gsl_rng * rng);
+                                     gsl_rng * rng, unsigned int i);
+void sprinkler_copy (Sprinkler * s, Sprinkler * s0);
+void sprinkler_add (Sprinkler * s, Sprinkler * s2);
+void sprinkler_free (Sprinkler * s);
+void sprinkler_drop (Sprinkler * s, Air * a, Trajectory * t, gsl_rng * rng,
+                     unsigned int i, FILE * file);
+int sprinkler_calculate_drops (Sprinkler * s, Air * a, FILE * file,
+                               unsigned int first, unsigned int last,
+                               unsigned int n, SprinklerLoad * load);
+int sprinkler_calculate (Sprinkler * s, Air * a, FILE * file,
+                         unsigned int n, SprinklerLoad * load);
+#if HAVE_MPI
+void sprinkler_mpi_reduce (Sprinkler * s);
+#endif
+int sprinkler_checkpoint_write (Sprinkler * s, FILE * file,
+                                unsigned int drops);
+int sprinkler_checkpoint_read (Sprinkler * s, FILE * file,
+                               unsigned int *drops);
+int sprinkler_calculate_batches (Sprinkler * s, Air * a, FILE * file,
+                                 unsigned int first, unsigned int n);
+int sprinkler_write_radial (Sprinkler * s, char *result);
+void sprinkler_uniformity (Sprinkler * s);
+int sprinkler_write_uniformity (Sprinkler * s, char *result);
 void sprinkler_error (char *message);
+int sprinkler_open_distribution (Sprinkler * s, char *name,
+                                 unsigned int columns,
+                                 unsigned int diameter_column,
+                                 unsigned int distance_column);
 void sprinkler_open_console (Sprinkler * s);
-int sprinkler_open_xml (Sprinkler * s, xmlNode * node);
+int sprinkler_open_xml (Sprinkler * s, Air * a, xmlNode * node);
 void sprinkler_run_console (Sprinkler * s, Air * a, Trajectory * t,
                             char *result);
+int sprinkler_run (Sprinkler * s, Air * a, Trajectory * t, xmlNode * node,
+                   char *result);
 int sprinkler_run_xml (Sprinkler * s, Air * a, Trajectory * t, xmlNode * node,
                        char *result);
 
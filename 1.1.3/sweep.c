@@ -0,0 +1,474 @@
+/*
+Sprinkler: a software to calculate drop trajectories in sprinkler irrigation.
+
+AUTHORS: Javier Burguete.
+
+Copyright 2012-2015, AUTHORS.
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+	1. Redistributions of source code must retain the above copyright notice,
+		this list of conditions and the following disclaimer.
+
+	2. Redistributions in binary form must reproduce the above copyright notice,
+		this list of conditions and the following disclaimer in the
+		documentation and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY AUTHORS ``AS IS'' AND ANY EXPRESS OR IMPLIED
+WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+SHALL AUTHORS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+
+/**
+ * \file sweep.c
+ * \brief Source file to run a parameter sweep of sprinkler simulations. The
+ *   input file is parsed once and every case is opened on the sprinkler node
+ *   with the swept attributes of the sprinkler or air nodes replaced. The cases
+ *   are calculated in parallel and their results are labelled by the swept
+ *   values.
+ * \author Javier Burguete Tolosa.
+ * \copyright Copyright 2012-2015 Javier Burguete Tolosa, all rights reserved.
+ */
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <libxml/parser.h>
+#include <glib.h>
+#include <libintl.h>
+#include <gsl/gsl_rng.h>
+#include "config.h"
+#include "utils.h"
+#include "trace.h"
+#include "air.h"
+#include "drop.h"
+#include "measurement.h"
+#include "trajectory.h"
+#include "sprinkler.h"
+#include "sweep.h"
+
+#define DEBUG_SWEEP 0           ///< macro to debug sweep functions.
+
+/**
+ * \fn void sweep_error (char *message)
+ * \brief function to show an error message opening a Sweep struct.
+ * \param message
+ * \brief error message.
+ */
+void
+sweep_error (char *message)
+{
+  error_message = g_strconcat (gettext ("Sweep"), ": ", message, NULL);
+}
+
+/**
+ * \fn void sweep_free (Sweep * s)
+ * \brief function to free the memory used by a Sweep struct.
+ * \param s
+ * \brief Sweep struct.
+ */
+void
+sweep_free (Sweep * s)
+{
+  unsigned int i;
+  for (i = 0; i < s->ncases; ++i)
+    {
+      sprinkler_free (s->sprinkler + i);
+      g_free (s->label[i]);
+    }
+  for (i = 0; i < s->nvariables; ++i)
+    {
+      xmlFree (s->variable[i].name);
+      g_strfreev (s->variable[i].value);
+    }
+  g_free (s->sprinkler);
+  g_free (s->air);
+  g_free (s->label);
+  g_free (s->variable);
+  s->sprinkler = NULL;
+  s->air = NULL;
+  s->label = NULL;
+  s->variable = NULL;
+  s->nvariables = s->ncases = 0;
+}
+
+/**
+ * \fn static unsigned int sweep_index (Sweep * s, unsigned int i, \
+ *   unsigned int j)
+ * \brief function to get the value index of a variable on a case. The first
+ *   variable changes slowest on cartesian designs.
+ * \param s
+ * \brief Sweep struct.
+ * \param i
+ * \brief case number.
+ * \param j
+ * \brief variable number.
+ * \return value index.
+ */
+static unsigned int
+sweep_index (Sweep * s, unsigned int i, unsigned int j)
+{
+  unsigned int k;
+  if (s->design == SWEEP_DESIGN_LIST)
+    return i;
+  for (k = s->nvariables; --k > j;)
+    i /= s->variable[k].nvalues;
+  return i % s->variable[j].nvalues;
+}
+
+/**
+ * \fn int sweep_open_xml (Sweep * s, xmlNode * node)
+ * \brief function to open a Sweep struct on a XML node. The input tree is not
+ *   modified, every case is opened on its own copy of the sprinkler node.
+ * \param s
+ * \brief Sweep struct.
+ * \param node
+ * \brief XML node.
+ * \return 1 on success, 0 on error.
+ */
+int
+sweep_open_xml (Sweep * s, xmlNode * node)
+{
+  SweepVariable *v;
+  GString *label;
+  xmlNode *child, *copy;
+  xmlChar *buffer;
+  char *value;
+  unsigned int i, j, ncases;
+  int k;
+#if DEBUG_SWEEP
+  fprintf (stderr, "sweep_open_xml: start\n");
+#endif
+  s->variable = NULL;
+  s->sprinkler = NULL;
+  s->air = NULL;
+  s->label = NULL;
+  s->nvariables = s->ncases = 0;
+  if (xmlStrcmp (node->name, XML_SWEEP))
+    {
+      sweep_error (gettext ("bad label"));
+      goto exit_on_error;
+    }
+  buffer = xmlGetProp (node, XML_DESIGN);
+  if (!buffer || !xmlStrcmp (buffer, XML_CARTESIAN))
+    s->design = SWEEP_DESIGN_CARTESIAN;
+  else if (!xmlStrcmp (buffer, XML_LIST))
+    s->design = SWEEP_DESIGN_LIST;
+  else
+    {
+      sweep_error (gettext ("unknown design"));
+      xmlFree (buffer);
+      goto exit_on_error;
+    }
+  xmlFree (buffer);
+  node = node->children;
+  if (!node || xmlStrcmp (node->name, XML_SPRINKLER))
+    {
+      sweep_error (gettext ("no sprinkler"));
+      goto exit_on_error;
+    }
+  if (!node->children || xmlStrcmp (node->children->name, XML_AIR))
+    {
+      sweep_error (gettext ("no air"));
+      goto exit_on_error;
+    }
+  for (child = node->next; child; child = child->next)
+    {
+      if (xmlStrcmp (child->name, XML_VARIABLE))
+        {
+          sweep_error (gettext ("bad variable label"));
+          goto exit_on_error;
+        }
+      s->variable = (SweepVariable *)
+        g_realloc (s->variable,
+                   (s->nvariables + 1) * sizeof (SweepVariable));
+      v = s->variable + s->nvariables;
+      v->value = NULL;
+      ++s->nvariables;
+      v->name = xmlGetProp (child, XML_NAME);
+      if (!v->name)
+        {
+          sweep_error (gettext ("no variable name"));
+          goto exit_on_error;
+        }
+      buffer = xmlGetProp (child, XML_NODE);
+      if (!buffer || !xmlStrcmp (buffer, XML_SPRINKLER))
+        v->node = SWEEP_NODE_SPRINKLER;
+      else if (!xmlStrcmp (buffer, XML_AIR))
+        v->node = SWEEP_NODE_AIR;
+      else
+        {
+          sweep_error (gettext ("unknown node"));
+          xmlFree (buffer);
+          goto exit_on_error;
+        }
+      xmlFree (buffer);
+
+      // values separated by blanks
+      buffer = xmlGetProp (child, XML_VALUES);
+      v->value = g_strsplit_set (buffer ? (char *) buffer : "", " \t\n", -1);
+      xmlFree (buffer);
+      for (i = j = 0; v->value[i]; ++i)
+        if (v->value[i][0])
+          v->value[j++] = v->value[i];
+        else
+          g_free (v->value[i]);
+      v->value[j] = NULL;
+      v->nvalues = j;
+      if (!j)
+        {
+          sweep_error (gettext ("no values"));
+          goto exit_on_error;
+        }
+    }
+  if (!s->nvariables)
+    {
+      sweep_error (gettext ("no variables"));
+      goto exit_on_error;
+    }
+  ncases = s->variable->nvalues;
+  for (j = 1; j < s->nvariables; ++j)
+    {
+      if (s->design == SWEEP_DESIGN_CARTESIAN)
+        ncases *= s->variable[j].nvalues;
+      else if (s->variable[j].nvalues != ncases)
+        {
+          sweep_error (gettext ("bad values number"));
+          goto exit_on_error;
+        }
+    }
+
+  // opening every case on a copy of the sprinkler node with its values
+  // replacing the node attributes
+  s->sprinkler = (Sprinkler *) g_malloc (ncases * sizeof (Sprinkler));
+  s->air = (Air *) g_malloc (ncases * sizeof (Air));
+  s->label = (char **) g_malloc (ncases * sizeof (char *));
+  for (i = 0; i < ncases; ++i)
+    {
+      copy = xmlCopyNode (node, 1);
+      label = g_string_new (NULL);
+      for (j = 0; j < s->nvariables; ++j)
+        {
+          v = s->variable + j;
+          value = v->value[sweep_index (s, i, j)];
+          xmlSetProp ((v->node == SWEEP_NODE_AIR) ? copy->children : copy,
+                      v->name, (const xmlChar *) value);
+          if (j)
+            g_string_append_c (label, '-');
+          g_string_append (label, value);
+        }
+      s->label[i] = g_strdelimit (g_string_free (label, FALSE), "/", '_');
+      k = sprinkler_open_xml (s->sprinkler + i, s->air + i, copy);
+      xmlFreeNode (copy);
+      if (!k)
+        {
+          sprinkler_free (s->sprinkler + i);
+          g_free (s->label[i]);
+          goto exit_on_error;
+        }
+      ++s->ncases;
+    }
+
+#if DEBUG_SWEEP
+  fprintf (stderr, "sweep_open_xml: end\n");
+#endif
+  return 1;
+
+exit_on_error:
+  sweep_free (s);
+#if DEBUG_SWEEP
+  fprintf (stderr, "sweep_open_xml: end\n");
+#endif
+  return 0;
+}
+
+/**
+ * \fn static gpointer sweep_thread (SweepThread * data)
+ * \brief function to calculate the sweep cases in a thread. Every thread takes
+ *   the next case not yet calculated, so the threads are balanced when the
+ *   cases have different costs. The error message of the first failed case is
+ *   passed to the SweepThread struct.
+ * \param data
+ * \brief SweepThread struct.
+ * \return NULL.
+ */
+static gpointer
+sweep_thread (SweepThread * data)
+{
+  Sweep *s;
+  Sprinkler *sprinkler;
+  FILE *file;
+  char *name;
+  unsigned int i;
+  s = data->sweep;
+  while ((i = (unsigned int) g_atomic_int_add (&data->next, 1)) < s->ncases)
+    {
+      sprinkler = s->sprinkler + i;
+      name = g_strconcat (data->result, "-", s->label[i], NULL);
+      file = NULL;
+      if (sprinkler->nmeasurements && !(file = fopen (name, "w")))
+        sweep_error (gettext ("unable to open the measurements file"));
+      else if (sprinkler_calculate (sprinkler, s->air + i, file,
+                                    data->nthreads, NULL)
+               && (!sprinkler->nrings
+                   || sprinkler_write_radial (sprinkler, name)))
+        {
+          if (sprinkler->nmeasurements)
+            sprinkler_uniformity (sprinkler);
+          if (file)
+            fclose (file);
+          g_free (name);
+          continue;
+        }
+      if (file)
+        fclose (file);
+      g_free (name);
+      if (g_atomic_int_compare_and_exchange (&data->error, 0, 1))
+        data->error_message = error_message;
+      else
+        g_free (error_message);
+      error_message = NULL;
+      break;
+    }
+  return NULL;
+}
+
+/**
+ * \fn int sweep_calculate (Sweep * s, char *result, unsigned int n)
+ * \brief function to calculate the sweep cases in parallel threads. With less
+ *   cases than threads the drops of every case are also calculated in
+ *   parallel.
+ * \param s
+ * \brief Sweep struct.
+ * \param result
+ * \brief results file name prefix.
+ * \param n
+ * \brief threads number.
+ * \return 1 on success, 0 on error.
+ */
+int
+sweep_calculate (Sweep * s, char *result, unsigned int n)
+{
+  SweepThread data[1];
+  GThread **thread;
+  unsigned int i;
+#if DEBUG_SWEEP
+  fprintf (stderr, "sweep_calculate: start\n");
+#endif
+  n = MAX (1, n);
+  data->sweep = s;
+  data->result = result;
+  data->nthreads = MAX (1, n / MAX (1, s->ncases));
+  data->next = data->error = 0;
+  data->error_message = NULL;
+  n = MIN (n, s->ncases);
+  thread = (GThread **) g_malloc (n * sizeof (GThread *));
+  for (i = 0; i < n; ++i)
+    thread[i] = g_thread_new (NULL, (GThreadFunc) sweep_thread, data);
+  for (i = 0; i < n; ++i)
+    g_thread_join (thread[i]);
+  g_free (thread);
+  if (data->error)
+    {
+      error_message = data->error_message;
+      if (!error_message)
+        sweep_error (gettext ("bad case"));
+    }
+#if DEBUG_SWEEP
+  fprintf (stderr, "sweep_calculate: end\n");
+#endif
+  return !data->error;
+}
+
+/**
+ * \fn int sweep_write (Sweep * s, char *result)
+ * \brief function to write the summary of the sweep cases: the swept values,
+ *   the mean drop landing distance and, with measurements, the uniformity
+ *   statistics of the measurement depths.
+ * \param s
+ * \brief Sweep struct.
+ * \param result
+ * \brief results file name.
+ * \return 1 on success, 0 on error.
+ */
+int
+sweep_write (Sweep * s, char *result)
+{
+  Sprinkler *sprinkler;
+  FILE *file;
+  unsigned int i, j;
+#if DEBUG_SWEEP
+  fprintf (stderr, "sweep_write: start\n");
+#endif
+  file = fopen (result, "w");
+  if (!file)
+    {
+      sweep_error (gettext ("unable to open the results file"));
+#if DEBUG_SWEEP
+      fprintf (stderr, "sweep_write: end\n");
+#endif
+      return 0;
+    }
+  fprintf (file, "# label");
+  for (j = 0; j < s->nvariables; ++j)
+    fprintf (file, " %s", (const char *) s->variable[j].name);
+  fprintf (file, " distance mean variance CU DU\n");
+  for (i = 0; i < s->ncases; ++i)
+    {
+      sprinkler = s->sprinkler + i;
+      fprintf (file, "%s", s->label[i]);
+      for (j = 0; j < s->nvariables; ++j)
+        fprintf (file, " %s", s->variable[j].value[sweep_index (s, i, j)]);
+      fprintf (file, " %.14le", sprinkler->ntrajectories ?
+               sprinkler->distance / sprinkler->ntrajectories : 0.);
+      if (sprinkler->nmeasurements)
+        fprintf (file, " %.14le %.14le %.14le %.14le", sprinkler->mean,
+                 sprinkler->variance, sprinkler->cu, sprinkler->du);
+      fprintf (file, "\n");
+    }
+  fclose (file);
+#if DEBUG_SWEEP
+  fprintf (stderr, "sweep_write: end\n");
+#endif
+  return 1;
+}
+
+/**
+ * \fn int sweep_run_xml (Sweep * s, xmlNode * node, char *result)
+ * \brief function to run a parameter sweep on a XML node.
+ * \param s
+ * \brief Sweep struct.
+ * \param node
+ * \brief XML node.
+ * \param result
+ * \brief results file name.
+ * \return 1 on success, 0 on error.
+ */
+int
+sweep_run_xml (Sweep * s, xmlNode * node, char *result)
+{
+  int k;
+#if DEBUG_SWEEP
+  fprintf (stderr, "sweep_run_xml: start\n");
+#endif
+  k = 0;
+  if (!sweep_open_xml (s, node))
+    goto exit_run;
+  k = sweep_calculate (s, result, nthreads) && sweep_write (s, result);
+  sweep_free (s);
+
+exit_run:
+#if DEBUG_SWEEP
+  fprintf (stderr, "sweep_run_xml: end\n");
+#endif
+  return k;
+}
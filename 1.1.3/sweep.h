@@ -0,0 +1,111 @@
+/*
+Sprinkler: a software to calculate drop trajectories in sprinkler irrigation.
+
+AUTHORS: Javier Burguete.
+
+Copyright 2012-2015, AUTHORS.
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+	1. Redistributions of source code must retain the above copyright notice,
+		this list of conditions and the following disclaimer.
+
+	2. Redistributions in binary form must reproduce the above copyright notice,
+		this list of conditions and the following disclaimer in the
+		documentation and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY AUTHORS ``AS IS'' AND ANY EXPRESS OR IMPLIED
+WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+SHALL AUTHORS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+
+/**
+ * \file sweep.h
+ * \brief Header file to run a parameter sweep of sprinkler simulations.
+ * \author Javier Burguete Tolosa.
+ * \copyright Copyright 2012-2015 Javier Burguete Tolosa, all rights reserved.
+ */
+#ifndef SWEEP__H
+#define SWEEP__H 1
+
+/**
+ * \enum SweepDesign
+ * \brief enum to define the combinations of the swept values.
+ */
+enum SweepDesign
+{
+  SWEEP_DESIGN_CARTESIAN = 0,
+  ///< all the combinations of the values of every variable.
+  SWEEP_DESIGN_LIST = 1
+    ///< the i-th case takes the i-th value of every variable.
+};
+
+/**
+ * \enum SweepNode
+ * \brief enum to define the XML nodes of the swept attributes.
+ */
+enum SweepNode
+{
+  SWEEP_NODE_SPRINKLER = 0,     ///< sprinkler node.
+  SWEEP_NODE_AIR = 1            ///< air node.
+};
+
+/**
+ * \struct SweepVariable
+ * \brief struct to define a swept attribute.
+ */
+typedef struct
+{
+  xmlChar *name;                ///< attribute name.
+  char **value;                 ///< array of attribute values.
+  unsigned int nvalues;         ///< number of values.
+  unsigned int node;            ///< XML node of the attribute.
+} SweepVariable;
+
+/**
+ * \struct Sweep
+ * \brief struct to define a parameter sweep.
+ */
+typedef struct
+{
+  SweepVariable *variable;      ///< array of SweepVariable structs.
+  Sprinkler *sprinkler;         ///< array of Sprinkler structs of the cases.
+  Air *air;                     ///< array of Air structs of the cases.
+  char **label;                 ///< array of case labels.
+  unsigned int nvariables;      ///< number of swept attributes.
+  unsigned int ncases;          ///< number of opened cases.
+  unsigned int design;          ///< combination of the swept values.
+} Sweep;
+
+/**
+ * \struct SweepThread
+ * \brief struct to define the data shared by the threads calculating the
+ *   sweep cases.
+ */
+typedef struct
+{
+  Sweep *sweep;                 ///< Sweep struct.
+  char *result;                 ///< results file name prefix.
+  unsigned int nthreads;        ///< threads number of every case.
+  volatile gint next;           ///< next case to calculate.
+  volatile gint error;          ///< 1 if a case failed, 0 otherwise.
+  char *error_message;          ///< error message of the first failed case.
+} SweepThread;
+
+void sweep_error (char *message);
+void sweep_free (Sweep * s);
+int sweep_open_xml (Sweep * s, xmlNode * node);
+int sweep_calculate (Sweep * s, char *result, unsigned int n);
+int sweep_write (Sweep * s, char *result);
+int sweep_run_xml (Sweep * s, xmlNode * node, char *result);
+
+#endif
@@ -0,0 +1,283 @@
+/*
+Sprinkler: a software to calculate drop trajectories in sprinkler irrigation.
+
+AUTHORS: Javier Burguete.
+
+Copyright 2012-2015, AUTHORS.
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+	1. Redistributions of source code must retain the above copyright notice,
+		this list of conditions and the following disclaimer.
+
+	2. Redistributions in binary form must reproduce the above copyright notice,
+		this list of conditions and the following disclaimer in the
+		documentation and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY AUTHORS ``AS IS'' AND ANY EXPRESS OR IMPLIED
+WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+SHALL AUTHORS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+
+/**
+ * \file trace.c
+ * \brief Source file to record a timeline of the calculation in the Chrome
+ *   trace event format. Every thread records its events in its own fixed size
+ *   buffer without locks. The buffers are written to the trace file, under a
+ *   mutex, when they fill, at the end of every run and when their threads
+ *   exit, so the memory is bounded and a long run or a server keeps its trace
+ *   up to date. The file uses the JSON array format, which can be loaded even
+ *   if the program ends before closing the array.
+ * \author Javier Burguete Tolosa.
+ * \copyright Copyright 2012-2015 Javier Burguete Tolosa, all rights reserved.
+ */
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <glib.h>
+#include "config.h"
+#include "trace.h"
+
+int trace_enabled = 0;          ///< 1 if the trace is enabled, 0 otherwise.
+
+static void trace_release (TraceThread * t);
+
+static FILE *trace_file = NULL; ///< trace file.
+static unsigned long long int trace_start;      ///< trace start time.
+static __thread TraceThread *trace_thread = NULL;
+///< traced events of the thread.
+static GPrivate trace_private = G_PRIVATE_INIT ((GDestroyNotify) trace_release);
+///< key to write and free the traced events of a thread at its exit.
+static unsigned int trace_nthreads = 0; ///< number of traced threads.
+static GMutex trace_mutex;      ///< mutex to write on the trace file.
+
+/**
+ * \fn static unsigned long long int trace_clock ()
+ * \brief function to get a monotonic time.
+ * \return time in nanoseconds.
+ */
+static unsigned long long int
+trace_clock ()
+{
+  struct timespec t;
+  clock_gettime (CLOCK_MONOTONIC, &t);
+  return 1000000000ull * t.tv_sec + t.tv_nsec;
+}
+
+/**
+ * \fn static void trace_write (TraceThread * t)
+ * \brief function to write the buffered events of a thread on the trace file
+ *   and to empty the buffer.
+ * \param t
+ * \brief TraceThread struct.
+ */
+static void
+trace_write (TraceThread * t)
+{
+  TraceEvent *e;
+  unsigned int i;
+  g_mutex_lock (&trace_mutex);
+  if (trace_file)
+    {
+      for (i = 0; i < t->nevents; ++i)
+        {
+          e = t->event + i;
+          fprintf (trace_file, ",\n{\"name\": \"%s\", \"ph\": \"X\", "
+                   "\"pid\": 1, \"tid\": %u, \"ts\": %.3lf, \"dur\": %.3lf",
+                   e->name, t->id, 1e-3 * e->begin,
+                   1e-3 * (e->end - e->begin));
+          if (e->diameter > 0.)
+            fprintf (trace_file, ", \"args\": {\"diameter\": %lg}",
+                     e->diameter);
+          fprintf (trace_file, "}");
+        }
+      fflush (trace_file);
+    }
+  g_mutex_unlock (&trace_mutex);
+  t->nevents = 0;
+}
+
+/**
+ * \fn static void trace_release (TraceThread * t)
+ * \brief function to write the buffered events of an exiting thread and to
+ *   free its buffer.
+ * \param t
+ * \brief TraceThread struct.
+ */
+static void
+trace_release (TraceThread * t)
+{
+  trace_write (t);
+  g_free (t);
+}
+
+/**
+ * \fn static TraceThread *trace_register ()
+ * \brief function to create the events buffer of the thread and to write its
+ *   name on the trace file.
+ * \return TraceThread struct.
+ */
+static TraceThread *
+trace_register ()
+{
+  TraceThread *t;
+  t = trace_thread = (TraceThread *) g_malloc (sizeof (TraceThread));
+  t->nevents = 0;
+  g_mutex_lock (&trace_mutex);
+  t->id = trace_nthreads++;
+  if (trace_file)
+    {
+      fprintf (trace_file, ",\n{\"name\": \"thread_name\", \"ph\": \"M\", "
+               "\"pid\": 1, \"tid\": %u, \"args\": {\"name\": ", t->id);
+      if (t->id)
+        fprintf (trace_file, "\"worker %u\"}}", t->id);
+      else
+        fprintf (trace_file, "\"main\"}}");
+    }
+  g_mutex_unlock (&trace_mutex);
+
+  // the buffer of the first thread is written at exit
+  if (t->id)
+    g_private_set (&trace_private, t);
+  return t;
+}
+
+/**
+ * \fn void trace_open (char *name)
+ * \brief function to open the trace file and to enable the trace.
+ * \param name
+ * \brief trace file name.
+ */
+void
+trace_open (char *name)
+{
+  if (trace_enabled)
+    return;
+  trace_file = fopen (name, "w");
+  if (!trace_file)
+    return;
+  fprintf (trace_file, "[{\"name\": \"process_name\", \"ph\": \"M\", "
+           "\"pid\": 1, \"args\": {\"name\": \"sprinkler\"}}");
+  trace_start = trace_clock ();
+  trace_register ();
+  atexit (trace_close);
+  trace_enabled = 1;
+}
+
+/**
+ * \fn unsigned long long int trace_time ()
+ * \brief function to get the time from the trace start.
+ * \return time in nanoseconds.
+ */
+unsigned long long int
+trace_time ()
+{
+  return trace_clock () - trace_start;
+}
+
+/**
+ * \fn static TraceEvent *trace_add (const char *name, \
+ *   unsigned long long int begin, unsigned long long int end)
+ * \brief function to add an event to the buffer of the thread, creating the
+ *   buffer on the first call and writing it when full.
+ * \param name
+ * \brief event name.
+ * \param begin
+ * \brief begin time in nanoseconds.
+ * \param end
+ * \brief end time in nanoseconds.
+ * \return TraceEvent struct.
+ */
+static TraceEvent *
+trace_add (const char *name, unsigned long long int begin,
+           unsigned long long int end)
+{
+  TraceThread *t;
+  TraceEvent *e;
+  t = trace_thread;
+  if (!t)
+    t = trace_register ();
+  else if (t->nevents == TRACE_EVENTS)
+    trace_write (t);
+  e = t->event + t->nevents++;
+  e->name = name;
+  e->begin = begin;
+  e->end = end;
+  e->diameter = 0.;
+  return e;
+}
+
+/**
+ * \fn void trace_event (const char *name, unsigned long long int begin, \
+ *   unsigned long long int end)
+ * \brief function to record an event.
+ * \param name
+ * \brief event name (it has to be a static string).
+ * \param begin
+ * \brief begin time in nanoseconds.
+ * \param end
+ * \brief end time in nanoseconds.
+ */
+void
+trace_event (const char *name, unsigned long long int begin,
+             unsigned long long int end)
+{
+  trace_add (name, begin, end);
+}
+
+/**
+ * \fn void trace_trajectory (unsigned long long int begin, \
+ *   unsigned long long int end, double diameter)
+ * \brief function to record the calculation of a drop trajectory.
+ * \param begin
+ * \brief begin time in nanoseconds.
+ * \param end
+ * \brief end time in nanoseconds.
+ * \param diameter
+ * \brief drop diameter.
+ */
+void
+trace_trajectory (unsigned long long int begin, unsigned long long int end,
+                  double diameter)
+{
+  trace_add ("trajectory", begin, end)->diameter = diameter;
+}
+
+/**
+ * \fn void trace_flush ()
+ * \brief function to write the buffered events of the thread at the end of a
+ *   run.
+ */
+void
+trace_flush ()
+{
+  if (trace_thread)
+    trace_write (trace_thread);
+}
+
+/**
+ * \fn void trace_close ()
+ * \brief function to write the buffered events of the thread and to close the
+ *   trace file.
+ */
+void
+trace_close ()
+{
+  trace_flush ();
+  g_mutex_lock (&trace_mutex);
+  fprintf (trace_file, "\n]\n");
+  fclose (trace_file);
+  trace_file = NULL;
+  g_mutex_unlock (&trace_mutex);
+}
@@ -0,0 +1,78 @@
+/*
+Sprinkler: a software to calculate drop trajectories in sprinkler irrigation.
+
+AUTHORS: Javier Burguete.
+
+Copyright 2012-2015, AUTHORS.
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+	1. Redistributions of source code must retain the above copyright notice,
+		this list of conditions and the following disclaimer.
+
+	2. Redistributions in binary form must reproduce the above copyright notice,
+		this list of conditions and the following disclaimer in the
+		documentation and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY AUTHORS ``AS IS'' AND ANY EXPRESS OR IMPLIED
+WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+SHALL AUTHORS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+
+/**
+ * \file trace.h
+ * \brief Header file to record a timeline of the calculation in the Chrome
+ *   trace event format.
+ * \author Javier Burguete Tolosa.
+ * \copyright Copyright 2012-2015 Javier Burguete Tolosa, all rights reserved.
+ */
+#ifndef TRACE__H
+#define TRACE__H 1
+
+#define TRACE_EVENTS 1024
+///< number of events of a thread buffer.
+
+/**
+ * \struct TraceEvent
+ * \brief struct to define a traced event.
+ */
+typedef struct
+{
+  const char *name;             ///< event name.
+  unsigned long long int begin; ///< begin time in nanoseconds.
+  unsigned long long int end;   ///< end time in nanoseconds.
+  double diameter;              ///< drop diameter or 0 if not applicable.
+} TraceEvent;
+
+/**
+ * \struct TraceThread
+ * \brief struct to define the traced events of a thread.
+ */
+typedef struct
+{
+  TraceEvent event[TRACE_EVENTS];       ///< buffer of events.
+  unsigned int nevents;         ///< number of buffered events.
+  unsigned int id;              ///< thread identifier.
+} TraceThread;
+
+extern int trace_enabled;
+
+void trace_open (char *name);
+unsigned long long int trace_time ();
+void trace_event (const char *name, unsigned long long int begin,
+                  unsigned long long int end);
+void trace_trajectory (unsigned long long int begin, unsigned long long int end,
+                       double diameter);
+void trace_flush ();
+void trace_close ();
+
+#endif
@@ -46,6 +46,8 @@ OF SUCH DAMAGE.
 #endif
 #include "config.h"
 #include "utils.h"
+#include "instrument.h"
+#include "trace.h"
 #include "air.h"
 #include "drop.h"
 #include "measurement.h"
@@ -53,8 +55,12 @@ OF SUCH DAMAGE.
 
 #define DEBUG_TRAJECTORY 0      ///< macro to debug trajectory functions.
 
-void (*trajectory_jet) (Trajectory * t, Air * a);
-  ///< pointer to the function to calculate the movement into the jet.
+void (*trajectory_jet[3]) (Trajectory * t, Air * a) = {
+  trajectory_jet_null_drag, trajectory_jet_progressive,
+  trajectory_jet_big_drops
+};
+  ///< array of pointers to the functions to calculate the movement into the
+  ///< jet ordered by jet model.
 
 /**
  * \fn void trajectory_init (Trajectory * t, Air * a, gsl_rng * rng)
@@ -73,17 +79,6 @@ trajectory_init (Trajectory * t, Air * a, gsl_rng * rng)
 #if DEBUG_TRAJECTORY
   fprintf (stderr, "trajectory_init: start\n");
 #endif
-  switch (t->jet_model)
-    {
-    case TRAJECTORY_JET_MODEL_NULL_DRAG:
-      trajectory_jet = trajectory_jet_null_drag;
-      break;
-    case TRAJECTORY_JET_MODEL_PROGRESSIVE:
-      trajectory_jet = trajectory_jet_progressive;
-      break;
-    default:
-      trajectory_jet = trajectory_jet_big_drops;
-    }
   d = t->drop;
   d->jet_time = t->jet_time;
   drop_init (d, a, rng);
@@ -288,16 +283,19 @@ trajectory_open_data (Trajectory * t, Air * a, gsl_rng * rng, double diameter,
                       unsigned int drag_model, double maximum_diameter,
                       double drag_coefficient)
 {
+  Drop *d;
 #if DEBUG_TRAJECTORY
   fprintf (stderr, "trajectory_open_data: start\n");
 #endif
+  d = t->drop;
   t->jet_model = jet_model;
+  t->drop_maximum_diameter = maximum_diameter;
   t->file = NULL;
-  drop_diameter = diameter;
-  drop_detach_model = detach_model;
-  drop_drag_model = drag_model;
-  drop_maximum_diameter = maximum_diameter;
-  drop_drag_coefficient = drag_coefficient;
+  d->diameter = diameter;
+  d->weight = 1.;
+  d->detach_model = detach_model;
+  d->drag_model = drag_model;
+  d->drag_coefficient = drag_coefficient;
 #if DEBUG_TRAJECTORY
   fprintf (stderr, "trajectory_open_data: end\n");
 #endif
@@ -321,6 +319,9 @@ trajectory_runge_kutta_4 (Trajectory * t, Air * a, double factor)
   double dt2, dt6;
 #if DEBUG_TRAJECTORY
   fprintf (stderr, "trajectory_runge_kutta_4: start\n");
+#endif
+#if INSTRUMENT
+  instrument_count (INSTRUMENT_RUNGE_KUTTA_4);
 #endif
   d = t->drop;
   memcpy (d2, d, sizeof (Drop));
@@ -628,37 +629,181 @@ trajectory_calculate (Trajectory * t, Air * a, Measurement * m, unsigned int n,
   Drop *d;
   double dt;
   unsigned int i;
+#if TRACE
+  unsigned long long int trace0, trace1, trace2;
+#endif
+#if INSTRUMENT
+  unsigned long long int t0, t1, output;
+#endif
 #if DEBUG_TRAJECTORY
   fprintf (stderr, "trajectory_calculate: start\n");
   fprintf (stderr, "trajectory_calculate: nmeasurements=%u\n", n);
+#endif
+#if INSTRUMENT
+  instrument_trajectory (t->drop->diameter);
+  t0 = instrument_time ();
+#endif
+#if TRACE
+  if (trace_enabled)
+    trace0 = trace2 = trace_time ();
 #endif
   t->t = 0.;
   if (t->file)
     trajectory_write (t);
-  trajectory_jet (t, a);
+#if INSTRUMENT
+  t1 = instrument_time ();
+  output = t1 - t0;
+  t0 = t1;
+#endif
+  trajectory_jet[t->jet_model] (t, a);
   d = t->drop;
+#if INSTRUMENT
+  t1 = instrument_time ();
+  instrument_phase (INSTRUMENT_JET, t1 - t0);
+  t0 = t1;
+#endif
+#if TRACE
+  if (trace_enabled)
+    {
+      trace1 = trace_time ();
+      trace_event ("jet", trace0, trace1);
+      trace0 = trace1;
+    }
+#endif
   for (dt = t->dt; d->r[2] > t->bed_level || d->v[2] > 0.;)
     {
+#if INSTRUMENT
+      t1 = instrument_time ();
+#endif
       if (t->file)
         trajectory_write (t);
+#if INSTRUMENT
+      output += instrument_time () - t1;
+#endif
       t->dt = fmin (dt, t->cfl / drop_move (d, a, 1.));
+#if INSTRUMENT
+      instrument_count (t->dt < dt ? INSTRUMENT_CFL_LIMITED
+                        : INSTRUMENT_DT_LIMITED);
+#endif
       memcpy (r, d->r, 3 * sizeof (double));
       trajectory_runge_kutta_4 (t, a, 1.);
+#if INSTRUMENT
+      t1 = instrument_time ();
+#endif
       for (i = 0; i < n; ++i)
         measurement_write (m + i, d, r, file);
+#if INSTRUMENT
+      output += instrument_time () - t1;
+#endif
     }
+#if INSTRUMENT
+  t1 = instrument_time ();
+  instrument_phase (INSTRUMENT_FLIGHT, t1 - t0 - output);
+  t0 = t1;
+#endif
+#if TRACE
+  if (trace_enabled)
+    {
+      trace1 = trace_time ();
+      trace_event ("flight", trace0, trace1);
+      trace0 = trace1;
+    }
+#endif
   trajectory_impact_correction (t, a);
+#if INSTRUMENT
+  t1 = instrument_time ();
+  instrument_phase (INSTRUMENT_IMPACT, t1 - t0);
+  t0 = t1;
+#endif
+#if TRACE
+  if (trace_enabled)
+    {
+      trace1 = trace_time ();
+      trace_event ("impact", trace0, trace1);
+      trace0 = trace1;
+    }
+#endif
   if (t->file)
     {
       trajectory_write (t);
       fclose (t->file);
       g_free (t->filename);
     }
+#if INSTRUMENT
+  output += instrument_time () - t0;
+  instrument_phase (INSTRUMENT_OUTPUT, output);
+#endif
+#if TRACE
+  if (trace_enabled)
+    {
+      trace1 = trace_time ();
+      trace_event ("output", trace0, trace1);
+      trace_trajectory (trace2, trace1, d->diameter);
+    }
+#endif
 #if DEBUG_TRAJECTORY
   fprintf (stderr, "trajectory_calculate: end\n");
 #endif
 }
 
+/**
+ * \fn void trajectory_landing (Trajectory * t, Air * a, gsl_rng * rng, \
+ *   const double *x, double bed_level, double dt, double cfl, double *y)
+ * \brief function to calculate the landing of a drop emitted without jet from
+ *   its initial data. The drop drag resistance model has to be set.
+ * \param t
+ * \brief Trajectory struct.
+ * \param a
+ * \brief Air struct.
+ * \param rng
+ * \brief GSL pseudo-random numbers generator struct.
+ * \param x
+ * \brief array of the drop initial data: x, y, z, velocity, horizontal angle
+ *   (in degrees), vertical angle (in degrees) and diameter.
+ * \param bed_level
+ * \brief bed level.
+ * \param dt
+ * \brief numerical time step size.
+ * \param cfl
+ * \brief stability number.
+ * \param y
+ * \brief array of the final drop state: time, position, velocity, axis ratio
+ *   and diameter.
+ */
+void
+trajectory_landing (Trajectory * t, Air * a, gsl_rng * rng, const double *x,
+                    double bed_level, double dt, double cfl, double *y)
+{
+  Drop *d;
+  double sh, ch, sv, cv;
+  d = t->drop;
+  d->r[0] = x[0];
+  d->r[1] = x[1];
+  d->r[2] = x[2];
+  d->diameter = x[6];
+  d->detach_model = DROP_DETACH_MODEL_TOTAL;
+  sincos (M_PI / 180. * x[4], &sh, &ch);
+  sincos (M_PI / 180. * x[5], &sv, &cv);
+  d->v[0] = x[3] * cv * ch;
+  d->v[1] = x[3] * cv * sh;
+  d->v[2] = x[3] * sv;
+  t->file = NULL;
+  t->t = t->jet_time = 0.;
+  t->bed_level = bed_level;
+  t->dt = dt;
+  t->cfl = cfl;
+  t->jet_model = TRAJECTORY_JET_MODEL_NULL_DRAG;
+  t->drop_maximum_diameter = MAXIMUM_DROP_DIAMETER;
+  trajectory_init (t, a, rng);
+  air_wind_uncertainty (a, rng);
+  trajectory_calculate (t, a, NULL, 0, NULL);
+  y[0] = t->t;
+  memcpy (y + 1, d->r, 3 * sizeof (double));
+  memcpy (y + 4, d->v, 3 * sizeof (double));
+  y[7] = d->axis_ratio;
+  y[8] = d->diameter;
+}
+
 /**
  * \fn void trajectory_invert (Trajectory *t, Air *a)
  * \brief function to calculate the inverse drop trajectory.
@@ -695,6 +840,34 @@ trajectory_invert (Trajectory * t, Air * a)
 #endif
 }
 
+/**
+ * \fn int trajectory_run_node (Trajectory * t, Air * a, gsl_rng * rng, \
+ *   xmlNode * node, char *result)
+ * \brief function to calculate a drop trajectory on a XML node.
+ * \param t
+ * \brief Trajectory struct.
+ * \param a
+ * \brief Air struct.
+ * \param rng
+ * \brief GSL pseudo-random numbers generator struct.
+ * \param node
+ * \brief XML node.
+ * \param result
+ * \brief result file name.
+ * \return 1 on success, 0 on error.
+ */
+int
+trajectory_run_node (Trajectory * t, Air * a, gsl_rng * rng, xmlNode * node,
+                     char *result)
+{
+  if (!trajectory_open_xml (t, a, node, result))
+    return 0;
+  trajectory_init (t, a, rng);
+  air_wind_uncertainty (a, rng);
+  trajectory_calculate (t, a, NULL, 0, t->file);
+  return 1;
+}
+
 /**
  * \fn int trajectory_run_xml (Trajectory * t, Air * a, xmlNode * node, \
  *   char *result)
@@ -722,13 +895,8 @@ trajectory_run_xml (Trajectory * t, Air * a, xmlNode * node, char *result)
   if (!air_open_xml (a, node))
     goto exit_on_error;
   for (node = node->next; node; node = node->next)
-    {
-      if (!trajectory_open_xml (t, a, node, result))
-        goto exit_on_error;
-      trajectory_init (t, a, rng);
-      air_wind_uncertainty (a, rng);
-      trajectory_calculate (t, a, NULL, 0, t->file);
-    }
+    if (!trajectory_run_node (t, a, rng, node, result))
+      goto exit_on_error;
   gsl_rng_free (rng);
 #if DEBUG_TRAJECTORY
   fprintf (stderr, "trajectory_run_xml: end\n");
@@ -65,7 +65,7 @@ typedef struct
   unsigned int jet_model;       ///< jet model type.
 } Trajectory;
 
-extern void (*trajectory_jet) (Trajectory * t, Air * a);
+extern void (*trajectory_jet[3]) (Trajectory * t, Air * a);
 
 void trajectory_init (Trajectory * t, Air * a, gsl_rng * rng);
 void trajectory_error (char *message);
@@ -84,7 +84,12 @@ void trajectory_initial_correction (Trajectory * t, Air * a);
 void trajectory_write (Trajectory * t);
 void trajectory_calculate (Trajectory * t, Air * a, Measurement * m,
                            unsigned int n, FILE * file);
+void trajectory_landing (Trajectory * t, Air * a, gsl_rng * rng,
+                         const double *x, double bed_level, double dt,
+                         double cfl, double *y);
 void trajectory_invert (Trajectory * t, Air * a);
+int trajectory_run_node (Trajectory * t, Air * a, gsl_rng * rng,
+                         xmlNode * node, char *result);
 int trajectory_run_xml (Trajectory * t, Air * a, xmlNode * node, char *result);
 
 #endif
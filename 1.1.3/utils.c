@@ -35,14 +35,17 @@ OF SUCH DAMAGE.
  */
 #define _GNU_SOURCE
 #include <stdio.h>
+#include <stdlib.h>
 #include <math.h>
 #include <libxml/parser.h>
+#include <glib.h>
 #if HAVE_GTK
 #include <gtk/gtk.h>
 #endif
 #include "utils.h"
 
-char *error_message = NULL;     ///< error message.
+__thread char *error_message = NULL;    ///< error message of every thread.
+unsigned int nthreads = 1;      ///< number of threads.
 
 #if HAVE_GTK
 
@@ -109,6 +112,280 @@ vector_module (double x, double y, double z)
   return sqrt (x * x + y * y + z * z);
 }
 
+/**
+ * \fn unsigned long int random_seed (unsigned long int seed, unsigned int i)
+ * \brief function to get the pseudo-random numbers generator seed of the i-th
+ *   drop mixing the bits with the SplitMix64 generator, so every drop has an
+ *   independent substream whatever the calculation order.
+ * \param seed
+ * \brief base seed.
+ * \param i
+ * \brief drop number.
+ * \return drop seed.
+ */
+unsigned long int
+random_seed (unsigned long int seed, unsigned int i)
+{
+  unsigned long long int x;
+  x = seed + 0x9E3779B97F4A7C15ULL * (i + 1ULL);
+  x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+  return (unsigned long int) (x ^ (x >> 31));
+}
+
+/**
+ * \fn static unsigned int bit_reverse (unsigned int x)
+ * \brief function to reverse the bits order of a 32 bits integer.
+ * \param x
+ * \brief integer.
+ * \return reversed integer.
+ */
+static unsigned int
+bit_reverse (unsigned int x)
+{
+  x = ((x >> 1) & 0x55555555u) | ((x & 0x55555555u) << 1);
+  x = ((x >> 2) & 0x33333333u) | ((x & 0x33333333u) << 2);
+  x = ((x >> 4) & 0x0F0F0F0Fu) | ((x & 0x0F0F0F0Fu) << 4);
+  x = ((x >> 8) & 0x00FF00FFu) | ((x & 0x00FF00FFu) << 8);
+  return (x >> 16) | (x << 16);
+}
+
+/**
+ * \fn void random_sobol (unsigned long int seed, unsigned int i, double *u)
+ * \brief function to get the i-th point of a scrambled Sobol quasi-random
+ *   sequence of RANDOM_SOBOL_DIMENSIONS dimensions. The point is calculated
+ *   directly from its number, so the drops can be calculated in any order, and
+ *   every dimension is Owen scrambled with the hash of Burley (2020) to get
+ *   unbiased estimates.
+ * \param seed
+ * \brief scrambling seed.
+ * \param i
+ * \brief point number.
+ * \param u
+ * \brief array of RANDOM_SOBOL_DIMENSIONS coordinates in (0,1).
+ */
+void
+random_sobol (unsigned long int seed, unsigned int i, double *u)
+{
+  // primitive polynomials and initial direction numbers of Joe and Kuo (2008)
+  const unsigned int degree[RANDOM_SOBOL_DIMENSIONS - 1] = { 1, 2, 3, 3 };
+  const unsigned int coefficients[RANDOM_SOBOL_DIMENSIONS - 1]
+    = { 0, 1, 1, 2 };
+  const unsigned int initial[RANDOM_SOBOL_DIMENSIONS - 1][3]
+    = { {1, 0, 0}, {1, 3, 0}, {1, 3, 1}, {1, 1, 1} };
+  unsigned int v[32];
+  unsigned int x, h, s, j, k, l;
+  for (l = 0; l < RANDOM_SOBOL_DIMENSIONS; ++l)
+    {
+      // direction numbers
+      if (!l)
+        for (k = 0; k < 32; ++k)
+          v[k] = 1u << (31 - k);
+      else
+        {
+          s = degree[l - 1];
+          for (k = 0; k < s; ++k)
+            v[k] = initial[l - 1][k] << (31 - k);
+          for (; k < 32; ++k)
+            {
+              v[k] = v[k - s] ^ (v[k - s] >> s);
+              for (j = 1; j < s; ++j)
+                if ((coefficients[l - 1] >> (s - 1 - j)) & 1)
+                  v[k] ^= v[k - j];
+            }
+        }
+
+      // Sobol point coordinate
+      for (k = x = 0; k < 32 && (i >> k); ++k)
+        if ((i >> k) & 1)
+          x ^= v[k];
+
+      // nested uniform scrambling
+      h = (unsigned int) random_seed (seed, l);
+      x = bit_reverse (x);
+      x ^= x * 0x3d20adeau;
+      x += h;
+      x *= (h >> 16) | 1u;
+      x ^= x * 0x05526c56u;
+      x ^= x * 0x53a22864u;
+      x = bit_reverse (x);
+      u[l] = (x + 0.5) / 4294967296.;
+    }
+}
+
+/**
+ * \fn void alias_table (double *p, unsigned int *alias, unsigned int n)
+ * \brief function to build the alias table of Walker (1977) of a discrete
+ *   distribution, so it can be sampled with only one uniform random number and
+ *   in a constant time.
+ * \param p
+ * \brief array of the n weights of the distribution on input and of the
+ *   acceptance probabilities of the alias table on output.
+ * \param alias
+ * \brief array of the n alias indexes.
+ * \param n
+ * \brief number of values of the distribution.
+ */
+void
+alias_table (double *p, unsigned int *alias, unsigned int n)
+{
+  unsigned int *small, *large;
+  double sum;
+  unsigned int i, j, k, nsmall, nlarge;
+  for (i = 0, sum = 0.; i < n; ++i)
+    sum += p[i];
+  small = (unsigned int *) g_malloc (2 * n * sizeof (unsigned int));
+  large = small + n;
+  for (i = nsmall = nlarge = 0; i < n; ++i)
+    {
+      alias[i] = i;
+      p[i] *= n / sum;
+      if (p[i] < 1.)
+        small[nsmall++] = i;
+      else
+        large[nlarge++] = i;
+    }
+  while (nsmall && nlarge)
+    {
+      j = small[--nsmall];
+      k = large[nlarge - 1];
+      alias[j] = k;
+      p[k] -= 1. - p[j];
+      if (p[k] < 1.)
+        {
+          --nlarge;
+          small[nsmall++] = k;
+        }
+    }
+
+  // the remaining values have unit probability but for rounding errors
+  while (nsmall)
+    p[small[--nsmall]] = 1.;
+  while (nlarge)
+    p[large[--nlarge]] = 1.;
+  g_free (small);
+}
+
+/**
+ * \fn unsigned int alias_sample (double *p, unsigned int *alias, \
+ *   unsigned int n, double u)
+ * \brief function to sample a discrete distribution with its alias table.
+ * \param p
+ * \brief array of the n acceptance probabilities of the alias table.
+ * \param alias
+ * \brief array of the n alias indexes.
+ * \param n
+ * \brief number of values of the distribution.
+ * \param u
+ * \brief uniform random number in [0,1).
+ * \return sampled value index.
+ */
+unsigned int
+alias_sample (double *p, unsigned int *alias, unsigned int n, double u)
+{
+  unsigned int i;
+  u *= n;
+  i = (unsigned int) u;
+  if (i >= n)
+    i = n - 1;
+  return (u - i < p[i]) ? i : alias[i];
+}
+
+/**
+ * \fn static int uniformity_compare (const void *a, const void *b)
+ * \brief function to compare two doubles with qsort.
+ * \param a
+ * \brief pointer to the first double.
+ * \param b
+ * \brief pointer to the second double.
+ * \return -1 if a<b, 1 if a>b, 0 if a=b.
+ */
+static int
+uniformity_compare (const void *a, const void *b)
+{
+  double x, y;
+  x = *(const double *) a;
+  y = *(const double *) b;
+  return (x > y) - (x < y);
+}
+
+/**
+ * \fn void uniformity (double *x, unsigned int n, double *mean, \
+ *   double *deviation, double *cu, double *du)
+ * \brief function to calculate the uniformity statistics of the water depths
+ *   collected on a set of points: the Christiansen (1942) uniformity
+ *   coefficient and the distribution uniformity of the low quarter, both in
+ *   percentage.
+ * \param x
+ * \brief array of depths (sorted on output).
+ * \param n
+ * \brief number of depths.
+ * \param mean
+ * \brief pointer to the mean depth.
+ * \param deviation
+ * \brief pointer to the standard deviation of the depths.
+ * \param cu
+ * \brief pointer to the Christiansen uniformity coefficient.
+ * \param du
+ * \brief pointer to the distribution uniformity of the low quarter.
+ */
+void
+uniformity (double *x, unsigned int n, double *mean, double *deviation,
+            double *cu, double *du)
+{
+  double m, s, a;
+  unsigned int i, q;
+  *mean = *deviation = *cu = *du = 0.;
+  if (!n)
+    return;
+  for (i = 0, m = 0.; i < n; ++i)
+    m += x[i];
+  m /= n;
+  for (i = 0, s = a = 0.; i < n; ++i)
+    {
+      s += (x[i] - m) * (x[i] - m);
+      a += fabs (x[i] - m);
+    }
+  *mean = m;
+  *deviation = sqrt (s / n);
+  if (m <= 0.)
+    return;
+  *cu = 100. * (1. - a / (n * m));
+  qsort (x, n, sizeof (double), uniformity_compare);
+  q = MAX (1, n / 4);
+  for (i = 0, a = 0.; i < q; ++i)
+    a += x[i];
+  *du = 100. * a / (q * m);
+}
+
+/**
+ * \fn void file_copy (FILE * file, FILE * file2, long int begin, \
+ *   long int end)
+ * \brief function to append a part of a temporary file to a file.
+ * \param file
+ * \brief file.
+ * \param file2
+ * \brief temporary file.
+ * \param begin
+ * \brief start of the part on the temporary file.
+ * \param end
+ * \brief end of the part on the temporary file.
+ */
+void
+file_copy (FILE * file, FILE * file2, long int begin, long int end)
+{
+  char buffer[4096];
+  size_t n;
+  fseek (file2, begin, SEEK_SET);
+  for (; begin < end; begin += n)
+    {
+      n = fread (buffer, 1, MIN (4096, end - begin), file2);
+      if (!n)
+        break;
+      fwrite (buffer, 1, n, file);
+    }
+}
+
 /**
  * \fn double xml_node_get_float (xmlNode * node, const xmlChar * prop, \
  *   int *error_code)
@@ -124,19 +401,16 @@ vector_module (double x, double y, double z)
 double
 xml_node_get_float (xmlNode * node, const xmlChar * prop, int *error_code)
 {
-  const xmlChar *buffer;
+  xmlChar *buffer;
   double x;
-  if (!xmlHasProp (node, prop))
-    {
-      *error_code = 0;
-      return 0.;
-    }
   buffer = xmlGetProp (node, prop);
   if (!buffer || sscanf ((char *) buffer, "%lf", &x) != 1)
     {
+      xmlFree (buffer);
       *error_code = 0;
       return 0.;
     }
+  xmlFree (buffer);
   *error_code = 1;
   return x;
 }
@@ -160,17 +434,18 @@ double
 xml_node_get_float_with_default (xmlNode * node, const xmlChar * prop,
                                  double default_value, int *error_code)
 {
-  const xmlChar *buffer;
+  xmlChar *buffer;
   double x;
   *error_code = 1;
-  if (!xmlHasProp (node, prop))
-    return default_value;
   buffer = xmlGetProp (node, prop);
-  if (!buffer || sscanf ((char *) buffer, "%lf", &x) != 1)
+  if (!buffer)
+    return default_value;
+  if (sscanf ((char *) buffer, "%lf", &x) != 1)
     {
       *error_code = 0;
-      return 0;
+      x = 0.;
     }
+  xmlFree (buffer);
   return x;
 }
 
@@ -193,16 +468,17 @@ unsigned int
 xml_node_get_uint_with_default (xmlNode * node, const xmlChar * prop,
                                 unsigned int default_value, int *error_code)
 {
-  const xmlChar *buffer;
+  xmlChar *buffer;
   unsigned int x;
   *error_code = 1;
-  if (!xmlHasProp (node, prop))
-    return default_value;
   buffer = xmlGetProp (node, prop);
-  if (!buffer || sscanf ((char *) buffer, "%u", &x) != 1)
+  if (!buffer)
+    return default_value;
+  if (sscanf ((char *) buffer, "%u", &x) != 1)
     {
       *error_code = 0;
-      return 0;
+      x = 0;
     }
+  xmlFree (buffer);
   return x;
 }
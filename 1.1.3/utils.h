@@ -36,7 +36,11 @@ OF SUCH DAMAGE.
 #ifndef UTILS__H
 #define UTILS__H 1
 
-extern char *error_message;
+#define RANDOM_SOBOL_DIMENSIONS 5
+///< number of dimensions of the Sobol quasi-random sequence.
+
+extern __thread char *error_message;
+extern unsigned int nthreads;
 
 #if HAVE_GTK
 extern GtkWindow *window_parent;
@@ -45,6 +49,14 @@ extern GtkWindow *window_parent;
 void show_error ();
 double interpolate (double x, double x1, double x2, double y1, double y2);
 double vector_module (double x, double y, double z);
+unsigned long int random_seed (unsigned long int seed, unsigned int i);
+void random_sobol (unsigned long int seed, unsigned int i, double *u);
+void alias_table (double *p, unsigned int *alias, unsigned int n);
+unsigned int alias_sample (double *p, unsigned int *alias, unsigned int n,
+                           double u);
+void uniformity (double *x, unsigned int n, double *mean, double *deviation,
+                 double *cu, double *du);
+void file_copy (FILE * file, FILE * file2, long int begin, long int end);
 double xml_node_get_float (xmlNode * node, const xmlChar * prop,
                            int *error_code);
 double xml_node_get_float_with_default (xmlNode * node, const xmlChar * prop,